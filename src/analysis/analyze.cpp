@@ -0,0 +1,85 @@
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <vector>
+#include "cfg.hpp"
+
+// Print the control-flow graph of a ROM, as a block list or for Graphviz
+// Usage: rugbe-analyze <rom> [--dot]
+
+static const char* END_NAMES[] = {
+    "fallthrough", "jump", "branch", "call", "return", "indirect", "invalid"
+};
+
+static void print_location(std::ostream& out, uint32_t offset) {
+    out << std::hex << std::setfill('0')
+        << std::setw(2) << rom_bank(offset) << ":"
+        << std::setw(4) << rom_address(offset)
+        << std::dec << std::setfill(' ');
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: rugbe-analyze <rom> [--dot]" << std::endl;
+        return 1;
+    }
+    bool dot = argc > 2 && std::strcmp(argv[2], "--dot") == 0;
+
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open ROM." << std::endl;
+        return 1;
+    }
+    std::vector<uint8_t> rom((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+
+    ControlFlowGraph cfg;
+    cfg.analyze(rom.data(), rom.size());
+
+    if (dot) {
+        std::cout << "digraph rom {" << std::endl;
+        for (const BasicBlock& block : cfg.blocks) {
+            for (uint32_t successor : block.successors) {
+                std::cout << "    \"";
+                print_location(std::cout, block.offset);
+                std::cout << "\" -> \"";
+                print_location(std::cout, successor);
+                std::cout << "\";" << std::endl;
+            }
+        }
+        std::cout << "}" << std::endl;
+        return 0;
+    }
+
+    // Blocks can overlap where code jumps into the middle of an
+    // instruction, so count each byte once
+    std::vector<bool> reached(rom.size());
+    size_t code = 0, instructions = 0;
+    for (const BasicBlock& block : cfg.blocks) {
+        for (uint32_t k = block.offset;
+             k < block.offset + block.size && k < rom.size(); ++k) {
+            if (!reached[k]) ++code;
+            reached[k] = true;
+        }
+        instructions += block.instructions;
+    }
+    std::cout << cfg.blocks.size() << " blocks, " << instructions
+              << " instructions, " << code << " of " << rom.size()
+              << " bytes reached" << std::endl;
+
+    for (const BasicBlock& block : cfg.blocks) {
+        print_location(std::cout, block.offset);
+        std::cout << std::setw(7) << block.size << std::setw(6)
+                  << block.instructions << "  " << std::left << std::setw(12)
+                  << END_NAMES[static_cast<int>(block.end)] << std::right;
+        for (uint32_t successor : block.successors) {
+            std::cout << " ";
+            print_location(std::cout, successor);
+        }
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
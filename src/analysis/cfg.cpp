@@ -0,0 +1,190 @@
+#include <algorithm>
+#include "cfg.hpp"
+#include "../cpu/opcodes.hpp"
+
+// Where execution can start without a jump: the entry point, the
+// interrupt vectors and the RST targets
+static const uint16_t ROOTS[] = {
+    0x0100,
+    0x0040, 0x0048, 0x0050, 0x0058, 0x0060,
+    0x0000, 0x0008, 0x0010, 0x0018, 0x0020, 0x0028, 0x0030, 0x0038
+};
+
+uint16_t rom_bank(uint32_t offset) {
+    return offset >> 14;
+}
+
+uint16_t rom_address(uint32_t offset) {
+    return offset < 0x4000 ? offset : 0x4000 | (offset & 0x3fff);
+}
+
+// ROM offset of addr as seen from code at from, or -1 if addr isn't in
+// the ROM
+static int64_t resolve(uint16_t addr, uint32_t from, size_t size) {
+    int64_t offset;
+    if (addr < 0x4000) {
+        offset = addr;
+    } else if (addr < 0x8000) {
+        uint32_t bank = std::max<uint32_t>(rom_bank(from), 1);
+        offset = bank * 0x4000 + (addr - 0x4000);
+    } else {
+        return -1;
+    }
+    return offset < static_cast<int64_t>(size) ? offset : -1;
+}
+
+// How the instruction in bytes at offset affects control flow.
+// FALLTHROUGH means it doesn't end a block. Sets target to the address it
+// jumps or calls to, or -1.
+static BlockEnd flow(const uint8_t* bytes, uint32_t offset, int& target) {
+    uint16_t addr = rom_address(offset);
+    uint16_t nn = bytes[1] | (bytes[2] << 8);
+    uint16_t rel = addr + 2 + static_cast<int8_t>(bytes[1]);
+
+    target = -1;
+    switch (bytes[0]) {
+        case 0x18:
+            target = rel;
+            return BlockEnd::JUMP;
+        case 0x20: case 0x28: case 0x30: case 0x38:
+            target = rel;
+            return BlockEnd::BRANCH;
+        case 0xc3:
+            target = nn;
+            return BlockEnd::JUMP;
+        case 0xc2: case 0xca: case 0xd2: case 0xda:
+            target = nn;
+            return BlockEnd::BRANCH;
+        case 0xc4: case 0xcc: case 0xd4: case 0xdc: case 0xcd:
+            target = nn;
+            return BlockEnd::CALL;
+        case 0xc7: case 0xcf: case 0xd7: case 0xdf:
+        case 0xe7: case 0xef: case 0xf7: case 0xff:
+            target = bytes[0] & 0x38;
+            return BlockEnd::CALL;
+        case 0xc0: case 0xc8: case 0xd0: case 0xd8:
+            return BlockEnd::BRANCH;
+        case 0xc9: case 0xd9:
+            return BlockEnd::RETURN;
+        case 0xe9:
+            return BlockEnd::INDIRECT;
+        case 0xd3: case 0xdb: case 0xdd: case 0xe3: case 0xe4: case 0xeb:
+        case 0xec: case 0xed: case 0xf4: case 0xfc: case 0xfd:
+            return BlockEnd::INVALID;
+        default:
+            return BlockEnd::FALLTHROUGH;
+    }
+}
+
+// Copy the instruction at offset, padding past the end of the ROM with
+// zeros. Returns false if it doesn't fit in the ROM.
+static bool fetch(const uint8_t* rom, size_t size, uint32_t offset,
+                  uint8_t* bytes) {
+    for (int k = 0; k < 3; ++k) {
+        bytes[k] = offset + k < size ? rom[offset + k] : 0;
+    }
+    return offset + opcode(bytes).length <= size;
+}
+
+void ControlFlowGraph::analyze(const uint8_t* rom, size_t size) {
+    blocks.clear();
+
+    // Pass 1: find every instruction reachable from the roots, and the
+    // leaders, the instructions that start a block
+    std::vector<bool> decoded(size), leader(size);
+    std::vector<uint32_t> pending;
+
+    auto add_leader = [&](int64_t offset) {
+        if (offset < 0) return;
+        leader[offset] = true;
+        if (!decoded[offset]) pending.push_back(offset);
+    };
+
+    for (uint16_t root : ROOTS) {
+        add_leader(resolve(root, 0, size));
+    }
+
+    while (!pending.empty()) {
+        uint32_t offset = pending.back();
+        pending.pop_back();
+
+        while (offset < size) {
+            // Control falls into code already found from elsewhere
+            if (decoded[offset]) {
+                leader[offset] = true;
+                break;
+            }
+            decoded[offset] = true;
+
+            uint8_t bytes[3];
+            if (!fetch(rom, size, offset, bytes)) break;
+            uint32_t next = offset + opcode(bytes).length;
+
+            int target;
+            BlockEnd end = flow(bytes, offset, target);
+            if (end == BlockEnd::FALLTHROUGH) {
+                offset = next;
+                continue;
+            }
+
+            if (target >= 0) add_leader(resolve(target, offset, size));
+            if (end == BlockEnd::BRANCH || end == BlockEnd::CALL) {
+                add_leader(next < size ? next : -1);
+            }
+            break;
+        }
+    }
+
+    // Pass 2: cut the code into blocks at the leaders
+    for (uint32_t start = 0; start < size; ++start) {
+        if (!leader[start]) continue;
+
+        BasicBlock block {start, 0, 0, BlockEnd::INVALID, {}};
+        uint32_t offset = start;
+        while (true) {
+            uint8_t bytes[3];
+            if (!fetch(rom, size, offset, bytes)) {
+                block.end = BlockEnd::INVALID;
+                break;
+            }
+            uint32_t next = offset + opcode(bytes).length;
+            ++block.instructions;
+
+            int target;
+            block.end = flow(bytes, offset, target);
+            if (block.end != BlockEnd::FALLTHROUGH) {
+                if (target >= 0) {
+                    int64_t successor = resolve(target, offset, size);
+                    if (successor >= 0) block.successors.push_back(successor);
+                }
+                if ((block.end == BlockEnd::BRANCH ||
+                     block.end == BlockEnd::CALL) && next < size) {
+                    block.successors.push_back(next);
+                }
+                offset = next;
+                break;
+            }
+
+            offset = next;
+            if (offset >= size) {
+                block.end = BlockEnd::INVALID;
+                break;
+            }
+            if (leader[offset]) {
+                block.successors.push_back(offset);
+                break;
+            }
+        }
+
+        block.size = std::max(offset, start + 1) - start;
+        blocks.push_back(std::move(block));
+    }
+}
+
+const BasicBlock* ControlFlowGraph::find(uint32_t offset) const {
+    auto it = std::lower_bound(blocks.begin(), blocks.end(), offset,
+        [](const BasicBlock& block, uint32_t offset) {
+            return block.offset < offset;
+        });
+    return it != blocks.end() && it->offset == offset ? &*it : nullptr;
+}
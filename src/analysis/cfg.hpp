@@ -0,0 +1,55 @@
+#ifndef CFG_HPP
+#define CFG_HPP
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Static control-flow analysis
+// Disassembles a ROM by recursive descent from the entry point, the
+// interrupt vectors and the RST targets, following every direct jump,
+// call and RST, and splits the code it reaches into basic blocks. Code
+// only reached through JP (HL) or from RAM is not found.
+//
+// Addresses in $4000-$7fff are resolved to the bank of the code that
+// jumps there; from bank 0, where the bank switched in isn't known
+// statically, they are assumed to be in bank 1.
+
+// How a basic block ends
+enum class BlockEnd: uint8_t {
+    FALLTHROUGH,    // runs into the next block, which is a jump target
+    JUMP,           // JP nn or JR
+    BRANCH,         // conditional JP, JR or RET; also falls through
+    CALL,           // CALL or RST; falls through once it returns
+    RETURN,         // RET or RETI
+    INDIRECT,       // JP (HL)
+    INVALID         // undefined opcode or end of ROM
+};
+
+struct BasicBlock {
+    // ROM offset of the first instruction, and length in bytes
+    uint32_t offset;
+    uint32_t size;
+
+    uint32_t instructions;
+    BlockEnd end;
+
+    // ROM offsets of the blocks control can pass to
+    std::vector<uint32_t> successors;
+};
+
+class ControlFlowGraph {
+    public:
+        // Blocks ordered by offset
+        std::vector<BasicBlock> blocks;
+
+        void analyze(const uint8_t* rom, size_t size);
+
+        // The block starting at offset, or nullptr
+        const BasicBlock* find(uint32_t offset) const;
+};
+
+// Bank and CPU address of a ROM offset
+uint16_t rom_bank(uint32_t offset);
+uint16_t rom_address(uint32_t offset);
+
+#endif // CFG_HPP
@@ -0,0 +1,445 @@
+#include <algorithm>
+#include "apu.hpp"
+#include "../cpu/cpu.hpp"
+
+// CPU clock rate, and cycles between frame sequencer ticks (512 Hz)
+static const int CLOCK_RATE       = 4194304;
+static const int SEQUENCER_PERIOD = 8192;
+
+// Shortest noise period followed step by step, about a sample at 48 kHz
+static const int NOISE_MIN_PERIOD = 64;
+
+// Output scale: the loudest mix (four channels at 15, master volume 8)
+// comes to 480, which this takes close to full scale
+static const int OUTPUT_SCALE = 64;
+
+// Bits set when reading each register: unused and write-only bits
+static const uint8_t READ_MASKS[48] = {
+    0x80, 0x3f, 0x00, 0xff, 0xbf,                   // NR10-NR14
+    0xff, 0x3f, 0x00, 0xff, 0xbf,                   // NR21-NR24
+    0x7f, 0xff, 0x9f, 0xff, 0xbf,                   // NR30-NR34
+    0xff, 0xff, 0x00, 0x00, 0xbf,                   // NR41-NR44
+    0x00, 0x00, 0x70,                               // NR50-NR52
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+// Square duty cycles: bit n is the level at step n
+static const uint8_t DUTY[4] = {0x80, 0x81, 0xe1, 0x7e};
+
+// Wave channel volume codes, as right shifts of the sample
+static const int WAVE_SHIFTS[4] = {4, 0, 1, 2};
+
+// Noise divisors for NR43's low bits
+static const int NOISE_DIVISORS[8] = {8, 16, 32, 48, 64, 80, 96, 112};
+
+Apu::Apu(Cpu* cpu)
+    : cpu {cpu}, registers {}, channels {}, sweep_timer {0},
+      sweep_enabled {false}, sweep_shadow {0}, lfsr {0x7fff},
+      sequencer_step {0}, next_tick {SEQUENCER_PERIOD}, synced {0},
+      frame_start {0}, synthesize {false},
+      left {SAMPLE_RATE / 10}, right {SAMPLE_RATE / 10}
+{
+    // Powered on, with both outputs at full volume, as the boot ROM
+    // leaves it
+    registers[0x14] = 0x77;
+    registers[0x15] = 0xf3;
+    registers[0x16] = 0x80;
+    set_sample_rate(SAMPLE_RATE);
+}
+
+bool Apu::dac_on(int n) const {
+    return n == 2 ? registers[0x0a] & 0x80 : registers[n * 5 + 2] & 0xf8;
+}
+
+int Apu::frequency(int n) const {
+    return registers[n * 5 + 3] | ((registers[n * 5 + 4] & 0x07) << 8);
+}
+
+int Apu::period(int n) const {
+    switch (n) {
+        case 2:
+            return (2048 - frequency(n)) * 2;
+        case 3:
+            return NOISE_DIVISORS[registers[0x12] & 0x07] << (registers[0x12] >> 4);
+        default:
+            return (2048 - frequency(n)) * 4;
+    }
+}
+
+uint8_t Apu::read(uint16_t addr) {
+    int r = addr - 0xff10;
+
+    // NR52 reports which channels are on, which depends on their length
+    // counters, so only it needs the APU caught up
+    if (r == 0x16) {
+        catch_up();
+        uint8_t status = registers[r] | READ_MASKS[r];
+        for (int n = 0; n < 4; ++n) {
+            if (channels[n].enabled) status |= 1 << n;
+        }
+        return status;
+    }
+    return registers[r] | READ_MASKS[r];
+}
+
+void Apu::write(uint16_t addr, uint8_t data) {
+    catch_up();
+    int r = addr - 0xff10;
+
+    // Wave RAM
+    if (r >= 0x20) {
+        registers[r] = data;
+        return;
+    }
+
+    // NR52. Powering off clears the other registers and silences every
+    // channel; powering on restarts the frame sequencer.
+    if (r == 0x16) {
+        bool was_powered = powered();
+        registers[r] = data & 0x80;
+        if (was_powered && !powered()) {
+            std::fill(registers.begin(), registers.begin() + 0x16, 0);
+            for (int n = 0; n < 4; ++n) {
+                channels[n].enabled = false;
+                output(n);
+            }
+        } else if (!was_powered && powered()) {
+            sequencer_step = 0;
+        }
+        return;
+    }
+
+    // The other registers ignore writes while powered off
+    if (!powered()) return;
+    registers[r] = data;
+
+    switch (r) {
+        // Length loads
+        case 0x01: case 0x06: case 0x10:
+            channels[r / 5].length = 64 - (data & 0x3f);
+            break;
+        case 0x0b:
+            channels[2].length = 256 - data;
+            break;
+
+        // Turning a DAC off turns its channel off
+        case 0x02: case 0x07: case 0x0a: case 0x11:
+            if (!dac_on(r / 5)) {
+                channels[r / 5].enabled = false;
+                output(r / 5);
+            }
+            break;
+
+        // Wave volume
+        case 0x0c:
+            output(2);
+            break;
+
+        case 0x04: case 0x09: case 0x0e: case 0x13:
+            if (data & 0x80) trigger(r / 5);
+            break;
+
+        // Master volume and panning change every channel's output
+        case 0x14: case 0x15:
+            for (int n = 0; n < 4; ++n) {
+                output(n);
+            }
+            break;
+    }
+}
+
+void Apu::trigger(int n) {
+    Channel& c = channels[n];
+    c.enabled = dac_on(n);
+    if (c.length == 0) c.length = n == 2 ? 256 : 64;
+    c.timer = period(n);
+
+    if (n == 2) {
+        c.position = 0;
+    } else {
+        c.volume = registers[n * 5 + 2] >> 4;
+        c.envelope_timer = registers[n * 5 + 2] & 0x07;
+    }
+
+    if (n == 3) lfsr = 0x7fff;
+
+    // Square 1 reloads its sweep, and checks the first step for overflow
+    // straight away
+    if (n == 0) {
+        int sweep_period = (registers[0x00] >> 4) & 0x07;
+        sweep_shadow = frequency(0);
+        sweep_timer = sweep_period ? sweep_period : 8;
+        sweep_enabled = sweep_period || (registers[0x00] & 0x07);
+        if (registers[0x00] & 0x07) sweep_frequency();
+    }
+
+    output(n);
+}
+
+void Apu::catch_up() {
+    run(cpu->clock());
+}
+
+void Apu::run(uint64_t until) {
+    while (synced < until) {
+        uint64_t to = std::min(until, next_tick);
+        if (synthesize) {
+            run_square(0, to);
+            run_square(1, to);
+            run_wave(to);
+            run_noise(to);
+        }
+        synced = to;
+
+        if (synced == next_tick) {
+            tick();
+            next_tick += SEQUENCER_PERIOD;
+        }
+    }
+}
+
+// Each channel steps its waveform every period cycles, adding a delta
+// only when that changes its output. timer holds the cycles from synced
+// to the next step.
+
+void Apu::run_square(int n, uint64_t to) {
+    Channel& c = channels[n];
+    if (!c.enabled) return;
+
+    uint8_t duty = DUTY[registers[n * 5 + 1] >> 6];
+    int p = period(n);
+    uint64_t t = synced + c.timer;
+    while (t < to) {
+        c.position = (c.position + 1) & 7;
+        c.level = (duty >> c.position) & 1;
+        output(n, t);
+        t += p;
+    }
+    c.timer = t - to;
+}
+
+void Apu::run_wave(uint64_t to) {
+    Channel& c = channels[2];
+    if (!c.enabled) return;
+
+    int p = period(2);
+    uint64_t t = synced + c.timer;
+    while (t < to) {
+        c.position = (c.position + 1) & 31;
+        uint8_t byte = registers[0x20 + c.position / 2];
+        c.level = c.position & 1 ? byte & 0x0f : byte >> 4;
+        output(2, t);
+        t += p;
+    }
+    c.timer = t - to;
+}
+
+void Apu::run_noise(uint64_t to) {
+    Channel& c = channels[3];
+    if (!c.enabled) return;
+
+    // At its fastest the noise steps several times per output sample,
+    // where the steps in between can't be heard, so the output only
+    // follows every few of them
+    int steps = std::max(1, NOISE_MIN_PERIOD / period(3));
+    int p = period(3) * steps;
+
+    // In 7-bit mode the feedback goes into bit 6 as well
+    bool short_mode = registers[0x12] & 0x08;
+    uint64_t t = synced + c.timer;
+    while (t < to) {
+        for (int i = 0; i < steps; ++i) {
+            int feedback = (lfsr ^ (lfsr >> 1)) & 1;
+            lfsr = (lfsr >> 1) | (feedback << 14);
+            if (short_mode) lfsr = (lfsr & ~0x40) | (feedback << 6);
+        }
+        c.level = ~lfsr & 1;
+        output(3, t);
+        t += p;
+    }
+    c.timer = t - to;
+}
+
+void Apu::tick() {
+    if (!powered()) return;
+
+    if ((sequencer_step & 1) == 0) clock_length();
+    if (sequencer_step == 2 || sequencer_step == 6) clock_sweep();
+    if (sequencer_step == 7) clock_envelope();
+    sequencer_step = (sequencer_step + 1) & 7;
+}
+
+void Apu::clock_length() {
+    for (int n = 0; n < 4; ++n) {
+        Channel& c = channels[n];
+        if ((registers[n * 5 + 4] & 0x40) && c.length > 0 && --c.length == 0) {
+            c.enabled = false;
+            output(n);
+        }
+    }
+}
+
+void Apu::clock_envelope() {
+    for (int n : {0, 1, 3}) {
+        Channel& c = channels[n];
+        uint8_t nrx2 = registers[n * 5 + 2];
+        if (!c.enabled || (nrx2 & 0x07) == 0 || --c.envelope_timer > 0) {
+            continue;
+        }
+
+        c.envelope_timer = nrx2 & 0x07;
+        if (nrx2 & 0x08) {
+            if (c.volume < 15) ++c.volume;
+        } else {
+            if (c.volume > 0) --c.volume;
+        }
+        output(n);
+    }
+}
+
+void Apu::clock_sweep() {
+    if (--sweep_timer > 0) return;
+
+    int sweep_period = (registers[0x00] >> 4) & 0x07;
+    sweep_timer = sweep_period ? sweep_period : 8;
+    if (!sweep_enabled || sweep_period == 0) return;
+
+    // A new frequency is written back and checked again, but only the
+    // first check's result is used
+    int f = sweep_frequency();
+    if (f <= 2047 && (registers[0x00] & 0x07)) {
+        sweep_shadow = f;
+        registers[0x03] = f & 0xff;
+        registers[0x04] = (registers[0x04] & ~0x07) | (f >> 8);
+        sweep_frequency();
+    }
+}
+
+int Apu::sweep_frequency() {
+    int delta = sweep_shadow >> (registers[0x00] & 0x07);
+    int f = registers[0x00] & 0x08 ? sweep_shadow - delta : sweep_shadow + delta;
+    if (f > 2047) {
+        channels[0].enabled = false;
+        output(0);
+    }
+    return f;
+}
+
+void Apu::output(int n) {
+    output(n, synced);
+}
+
+void Apu::output(int n, uint64_t t) {
+    if (!synthesize) return;
+
+    Channel& c = channels[n];
+    int amplitude = 0;
+    if (c.enabled) {
+        amplitude = n == 2 ? c.level >> WAVE_SHIFTS[(registers[0x0c] >> 5) & 0x03]
+                           : c.level * c.volume;
+    }
+
+    // NR51 routes each channel to either side, and NR50 sets each side's
+    // volume from 1 to 8
+    uint8_t nr50 = registers[0x14];
+    uint8_t nr51 = registers[0x15];
+    int l = (nr51 >> (4 + n)) & 1 ? amplitude * (((nr50 >> 4) & 0x07) + 1) : 0;
+    int r = (nr51 >> n) & 1 ? amplitude * ((nr50 & 0x07) + 1) : 0;
+
+    uint32_t time = t - frame_start;
+    if (l != c.left) {
+        left.add_delta(time, l - c.left);
+        c.left = l;
+    }
+    if (r != c.right) {
+        right.add_delta(time, r - c.right);
+        c.right = r;
+    }
+}
+
+void Apu::set_output(bool on) {
+    catch_up();
+    if (on == synthesize) return;
+
+    // Carry on in the buffers where the last frame ended, from the
+    // channels' current output
+    synthesize = on;
+    frame_start = synced;
+    if (on) {
+        for (int n = 0; n < 4; ++n) {
+            output(n);
+        }
+    }
+}
+
+void Apu::set_sample_rate(double rate) {
+    left.set_rates(CLOCK_RATE, rate);
+    right.set_rates(CLOCK_RATE, rate);
+}
+
+void Apu::end_frame() {
+    catch_up();
+    if (!synthesize) return;
+
+    left.end_frame(synced - frame_start);
+    right.end_frame(synced - frame_start);
+    frame_start = synced;
+}
+
+size_t Apu::read_samples(int16_t* out, size_t count) {
+    count = left.read_samples(out, count, 2, OUTPUT_SCALE);
+    right.read_samples(out + 1, count, 2, OUTPUT_SCALE);
+    return count;
+}
+
+void Apu::save_state(ApuState& state) {
+    catch_up();
+    std::copy(registers.begin(), registers.end(), state.registers);
+    for (int n = 0; n < 4; ++n) {
+        const Channel& c = channels[n];
+        ApuChannelState& s = state.channels[n];
+        s.enabled = c.enabled;
+        s.volume = c.volume;
+        s.envelope_timer = c.envelope_timer;
+        s.position = c.position;
+        s.length = c.length;
+        s.reserved = 0;
+        s.timer = c.timer;
+    }
+    state.sweep_shadow = sweep_shadow;
+    state.sweep_timer = sweep_timer;
+    state.sweep_enabled = sweep_enabled;
+    state.lfsr = lfsr;
+    state.sequencer_step = sequencer_step;
+    state.reserved = 0;
+    state.next_tick = next_tick - synced;
+}
+
+void Apu::load_state(const ApuState& state) {
+    // Keep the buffers' place in time while the clock moves
+    uint64_t elapsed = synced - frame_start;
+    synced = cpu->clock();
+    frame_start = synced - elapsed;
+    next_tick = synced + state.next_tick;
+
+    std::copy(state.registers, state.registers + 48, registers.begin());
+    for (int n = 0; n < 4; ++n) {
+        Channel& c = channels[n];
+        const ApuChannelState& s = state.channels[n];
+        c.enabled = s.enabled;
+        c.volume = s.volume;
+        c.envelope_timer = s.envelope_timer;
+        c.position = s.position;
+        c.length = s.length;
+        c.timer = s.timer;
+    }
+    sweep_shadow = state.sweep_shadow;
+    sweep_timer = state.sweep_timer;
+    sweep_enabled = state.sweep_enabled;
+    lfsr = state.lfsr;
+    sequencer_step = state.sequencer_step;
+
+    for (int n = 0; n < 4; ++n) {
+        output(n);
+    }
+}
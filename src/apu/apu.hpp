@@ -0,0 +1,137 @@
+#ifndef APU_HPP
+#define APU_HPP
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "blip_buffer.hpp"
+#include "../state/state.hpp"
+class Cpu;
+
+// Audio processing unit ($ff10-$ff3f)
+// Two square channels, the first with a frequency sweep, a wave channel
+// playing 32 samples from wave RAM and a noise channel, clocked by a
+// 512 Hz frame sequencer for their length counters, envelopes and sweep.
+// Like the PPU, the APU doesn't run as the CPU does: it catches up to the
+// CPU's clock when one of its registers is accessed and when a frame
+// ends, stepping each channel from one level change to the next and
+// adding the changes to a pair of blip buffers.
+//
+// The frame sequencer counts from power-on rather than from DIV, so
+// writes to DIV don't shift it.
+//
+// Synthesis is off unless output is enabled. The frame sequencer still
+// runs, so the registers read the same either way, but the channels
+// themselves are never stepped.
+
+class Apu {
+    private:
+        struct Channel {
+            bool enabled;
+
+            // Length counter, counting down while enabled in NRx4
+            int length;
+
+            // Envelope volume and ticks to its next step
+            int volume;
+            int envelope_timer;
+
+            // Cycles to the next waveform step, and the position within
+            // the waveform: duty step or wave sample
+            int timer;
+            int position;
+
+            // Waveform output before volume: 0 or 1, or the wave sample
+            int level;
+
+            // Output last added to the left and right buffers
+            int left;
+            int right;
+        };
+
+        Cpu* cpu;
+
+        // $ff10-$ff3f, with wave RAM at the end
+        std::array<uint8_t, 48> registers;
+
+        std::array<Channel, 4> channels;
+
+        // Square 1 sweep
+        int sweep_timer;
+        bool sweep_enabled;
+        int sweep_shadow;
+
+        // Noise shift register
+        uint16_t lfsr;
+
+        // Frame sequencer step, and clock of its next tick
+        int sequencer_step;
+        uint64_t next_tick;
+
+        // Clock the APU has run up to, and clock at which the current
+        // output frame began
+        uint64_t synced;
+        uint64_t frame_start;
+
+        bool synthesize;
+        BlipBuffer left;
+        BlipBuffer right;
+
+        bool powered() const { return registers[0x16] & 0x80; }
+        bool dac_on(int) const;
+        int frequency(int) const;
+        int period(int) const;
+
+        // Run the frame sequencer and channels up to a clock
+        void run(uint64_t);
+        void run_square(int, uint64_t);
+        void run_wave(uint64_t);
+        void run_noise(uint64_t);
+
+        // Frame sequencer step and its parts
+        void tick();
+        void clock_length();
+        void clock_envelope();
+        void clock_sweep();
+
+        // Square 1's next swept frequency, disabling it on overflow
+        int sweep_frequency();
+
+        void trigger(int);
+
+        // Add a channel's change of output at the current clock or t
+        void output(int);
+        void output(int, uint64_t);
+
+    public:
+        // Output sample rate, before rate control
+        static constexpr int SAMPLE_RATE = 48000;
+
+        Apu(Cpu*);
+
+        uint8_t read(uint16_t);
+        void write(uint16_t, uint8_t);
+
+        // Bring the APU up to the CPU's clock
+        void catch_up();
+
+        // Turn synthesis on or off. Off, no samples are produced.
+        void set_output(bool);
+        bool output_enabled() const { return synthesize; }
+
+        // Nudge the output rate, for the frontend's rate control
+        void set_sample_rate(double);
+
+        // Catch up and make the frame's samples readable
+        void end_frame();
+
+        // Read up to count stereo samples, interleaved, into out
+        size_t read_samples(int16_t* out, size_t count);
+
+        // Copy registers to/from a save state. Times are stored relative
+        // to the CPU's clock, which must be loaded first.
+        void save_state(ApuState&);
+        void load_state(const ApuState&);
+};
+
+#endif // APU_HPP
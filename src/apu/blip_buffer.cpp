@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "blip_buffer.hpp"
+
+// Samples each step is spread over, and sub-sample positions as bits
+static const int KERNEL_SIZE = 16;
+static const int PHASE_BITS  = 5;
+static const int PHASES      = 1 << PHASE_BITS;
+
+// Fraction bits of the kernel, each phase of which sums to 1 << KERNEL_BITS
+static const int KERNEL_BITS = 15;
+
+// Band-limited impulses for each sub-sample phase: a Blackman-windowed
+// sinc, cut off a little below Nyquist
+struct Kernel {
+    int16_t taps[PHASES][KERNEL_SIZE];
+
+    Kernel() {
+        const double cutoff = 0.9;
+        const double pi = 3.14159265358979323846;
+
+        for (int p = 0; p < PHASES; ++p) {
+            double f[KERNEL_SIZE];
+            double sum = 0;
+            for (int k = 0; k < KERNEL_SIZE; ++k) {
+                double x = k - KERNEL_SIZE / 2 + 1 - double(p) / PHASES;
+                double sinc = x == 0 ? 1 : std::sin(pi * cutoff * x) /
+                                           (pi * cutoff * x);
+                double w = (k + 1 - double(p) / PHASES) / KERNEL_SIZE;
+                f[k] = sinc * (0.42 - 0.5 * std::cos(2 * pi * w) +
+                               0.08 * std::cos(4 * pi * w));
+                sum += f[k];
+            }
+
+            // Normalise so each phase sums exactly to one, putting the
+            // rounding error in the centre tap
+            int total = 0;
+            for (int k = 0; k < KERNEL_SIZE; ++k) {
+                taps[p][k] = std::lround(f[k] / sum * (1 << KERNEL_BITS));
+                total += taps[p][k];
+            }
+            taps[p][KERNEL_SIZE / 2] += (1 << KERNEL_BITS) - total;
+        }
+    }
+};
+
+static const Kernel KERNEL;
+
+BlipBuffer::BlipBuffer(size_t max_samples)
+    : buffer(max_samples + KERNEL_SIZE, 0), factor {0}, offset {0},
+      integrator {0}, dc {0} {}
+
+void BlipBuffer::set_rates(double clock_rate, double sample_rate) {
+    factor = std::llround(sample_rate / clock_rate * 4294967296.0);
+}
+
+void BlipBuffer::clear() {
+    std::fill(buffer.begin(), buffer.end(), 0);
+    offset = 0;
+    integrator = 0;
+    dc = 0;
+}
+
+void BlipBuffer::add_delta(uint32_t time, int delta) {
+    uint64_t pos = offset + time * factor;
+    size_t index = pos >> 32;
+    int phase = (pos >> (32 - PHASE_BITS)) & (PHASES - 1);
+
+    // Deltas past the end are dropped; the reader has fallen behind
+    if (index + KERNEL_SIZE > buffer.size()) return;
+
+    int32_t* out = &buffer[index];
+    const int16_t* taps = KERNEL.taps[phase];
+    for (int k = 0; k < KERNEL_SIZE; ++k) {
+        out[k] += taps[k] * delta;
+    }
+}
+
+void BlipBuffer::end_frame(uint32_t time) {
+    offset += time * factor;
+
+    // Keep at most a buffer's worth if nothing is reading
+    uint64_t limit = uint64_t(buffer.size() - KERNEL_SIZE) << 32;
+    if (offset > limit) offset = limit;
+}
+
+size_t BlipBuffer::read_samples(int16_t* out, size_t count, int stride,
+                                int scale) {
+    count = std::min(count, samples_available());
+
+    for (size_t i = 0; i < count; ++i) {
+        integrator += buffer[i];
+        int32_t sample = (integrator >> (KERNEL_BITS - 8)) * scale >> 8;
+
+        // One-pole high-pass filter to remove DC
+        dc += ((int64_t(sample) << 16) - dc) >> 10;
+        sample -= dc >> 16;
+
+        out[i * stride] = std::clamp(sample, -32768, 32767);
+    }
+
+    // Move the unread samples and the kernel tail to the front
+    size_t remaining = buffer.size() - count;
+    std::memmove(buffer.data(), buffer.data() + count,
+                 remaining * sizeof(int32_t));
+    std::fill(buffer.begin() + remaining, buffer.end(), 0);
+    offset -= uint64_t(count) << 32;
+    return count;
+}
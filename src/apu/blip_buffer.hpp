@@ -0,0 +1,51 @@
+#ifndef BLIP_BUFFER_HPP
+#define BLIP_BUFFER_HPP
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Band-limited synthesis buffer
+// Channels don't produce samples. They add a delta whenever their output
+// level changes, at the clock it changes, and each delta is spread over
+// a few output samples as a band-limited step taken from a windowed-sinc
+// table. Reading integrates the deltas into samples. The cost depends on
+// how often the level changes, not on the sample rate, and
+// there is no aliasing from square edges between samples.
+
+class BlipBuffer {
+    private:
+        // Deltas of the samples not yet read, plus room for the kernel
+        std::vector<int32_t> buffer;
+
+        // Output samples per clock, and the position of clock 0 of the
+        // current frame, both with 32 fraction bits
+        uint64_t factor;
+        uint64_t offset;
+
+        // Running sum of the deltas read so far, and its DC level
+        int32_t integrator;
+        int64_t dc;
+
+    public:
+        // Room for max_samples samples between reads
+        BlipBuffer(size_t max_samples);
+
+        void set_rates(double clock_rate, double sample_rate);
+
+        // Drop everything not yet read
+        void clear();
+
+        // Add a change of level at a clock since the frame started
+        void add_delta(uint32_t time, int delta);
+
+        // End the frame after time clocks, making its samples readable
+        void end_frame(uint32_t time);
+
+        size_t samples_available() const { return offset >> 32; }
+
+        // Read up to count samples into out, every stride entries. Samples
+        // are the levels added, times scale, with DC removed.
+        size_t read_samples(int16_t* out, size_t count, int stride, int scale);
+};
+
+#endif // BLIP_BUFFER_HPP
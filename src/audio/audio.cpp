@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include "audio.hpp"
+#include "../apu/apu.hpp"
+
+// Stereo samples in the ring, about 85 ms at 48 kHz, and in each device
+// callback
+const size_t RING_SIZE   = 4096;
+const int DEVICE_SAMPLES = 1024;
+
+// Largest change of output rate used for rate control, and for matching
+// the display
+const double MAX_RATE_DELTA = 0.005;
+const double MAX_STRETCH    = 0.01;
+
+// Game Boy frames per second: 4194304 Hz / 70224 cycles
+const double FRAME_RATE = 59.7275;
+
+// Longest wait() blocks, so a stalled device can't hang emulation
+const std::chrono::milliseconds MAX_WAIT(100);
+
+Audio::Audio()
+    : device {0}, rate {Apu::SAMPLE_RATE}, ring {RING_SIZE}, stretch {1.0},
+      resampling {false}, phase {0.0}, last {0, 0}, waiting {false} {}
+
+Audio::~Audio() {
+    if (device) SDL_CloseAudioDevice(device);
+}
+
+bool Audio::setup() {
+    SDL_AudioSpec want {};
+    want.freq = Apu::SAMPLE_RATE;
+    want.format = AUDIO_S16SYS;
+    want.channels = 2;
+    want.samples = DEVICE_SAMPLES;
+    want.callback = callback;
+    want.userdata = this;
+
+    SDL_AudioSpec have;
+    device = SDL_OpenAudioDevice(nullptr, 0, &want, &have,
+                                 SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+    if (device == 0) {
+        std::cerr << "Failed to open audio device: " << SDL_GetError()
+                  << std::endl;
+        return false;
+    }
+
+    rate = have.freq;
+    SDL_PauseAudioDevice(device, 0);
+    return true;
+}
+
+void Audio::callback(void* userdata, Uint8* stream, int len) {
+    Audio* audio = static_cast<Audio*>(userdata);
+    int16_t* out = reinterpret_cast<int16_t*>(stream);
+    size_t count = len / (2 * sizeof(int16_t));
+
+    // Silence for whatever the emulator hasn't produced yet
+    size_t got = audio->ring.pop(out, count);
+    std::fill(out + got * 2, out + count * 2, 0);
+
+    // Taking the lock orders the notification after wait()'s check
+    if (audio->waiting.load()) {
+        { std::lock_guard<std::mutex> lock(audio->mutex); }
+        audio->drained.notify_one();
+    }
+}
+
+void Audio::queue(const int16_t* samples, size_t count, Apu& apu) {
+    // Below half full, produce a little more per frame; above, a little
+    // less. The fill is taken before this frame's samples, as wait()
+    // leaves it.
+    double fill = double(ring.size()) / ring.capacity();
+    double target = rate * stretch * (1.0 + MAX_RATE_DELTA * (1.0 - 2.0 * fill));
+
+    if (resampling) {
+        push_resampled(samples, count, Apu::SAMPLE_RATE / target);
+        return;
+    }
+    apu.set_sample_rate(target);
+    ring.push(samples, count);
+}
+
+void Audio::set_resampling(bool on) {
+    resampling = on;
+    phase = 0.0;
+    last[0] = last[1] = 0;
+}
+
+// Linear interpolation, taking step input samples per output sample
+void Audio::push_resampled(const int16_t* samples, size_t count, double step) {
+    resampled.clear();
+    double position = phase;
+    while (position < count) {
+        size_t i = static_cast<size_t>(position);
+        double t = position - i;
+        for (int c = 0; c < 2; ++c) {
+            int16_t a = i == 0 ? last[c] : samples[(i - 1) * 2 + c];
+            int16_t b = samples[i * 2 + c];
+            resampled.push_back(static_cast<int16_t>(a + (b - a) * t));
+        }
+        position += step;
+    }
+
+    phase = position - count;
+    if (count > 0) {
+        last[0] = samples[(count - 1) * 2];
+        last[1] = samples[(count - 1) * 2 + 1];
+    }
+    ring.push(resampled.data(), resampled.size() / 2);
+}
+
+void Audio::match_display(double refresh_rate) {
+    double ratio = FRAME_RATE / refresh_rate;
+    stretch = std::abs(ratio - 1.0) <= MAX_STRETCH ? ratio : 1.0;
+}
+
+void Audio::wait() {
+    if (device == 0) return;
+
+    size_t target = ring.capacity() / 2;
+    std::unique_lock<std::mutex> lock(mutex);
+    waiting.store(true);
+    drained.wait_for(lock, MAX_WAIT, [&] { return ring.size() <= target; });
+    waiting.store(false);
+}
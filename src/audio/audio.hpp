@@ -0,0 +1,89 @@
+#ifndef AUDIO_HPP
+#define AUDIO_HPP
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "sample_ring.hpp"
+class Apu;
+
+// SDL audio output
+// Each frame's samples go into a ring that the device's callback drains.
+// The Game Boy's frame rate and the host's audio clock never quite agree,
+// so the ring would slowly fill or run dry. Instead, each frame the APU's
+// output rate is nudged by up to MAX_RATE_DELTA, in proportion to how far
+// the ring is from half full, which keeps it there without audible pitch
+// changes.
+//
+// Audio can also pace emulation. wait() blocks until the device has
+// played the ring down to half full, so frames are emulated exactly as
+// fast as the device consumes samples, with no wall-clock sleeps.
+// Stretching each frame's samples to last one display refresh rather
+// than 1/59.73 s then makes one emulated frame per refresh, so frames
+// never have to be repeated or skipped to reconcile the two rates.
+//
+// When the samples go somewhere else as well, such as a capture, the APU
+// can be left at Apu::SAMPLE_RATE instead, and its output resampled to
+// the adjusted rate on the way into the ring.
+
+class Audio {
+    private:
+        SDL_AudioDeviceID device;
+
+        // Sample rate the device was opened at
+        int rate;
+
+        SampleRing ring;
+
+        // Output rate relative to the device's, to match a display
+        double stretch;
+
+        // Resampling instead of adjusting the APU: the position of the
+        // next output sample after the last input sample, in input
+        // samples, and that last sample
+        bool resampling;
+        double phase;
+        int16_t last[2];
+        std::vector<int16_t> resampled;
+
+        void push_resampled(const int16_t*, size_t, double);
+
+        // Signalled by the callback while wait() is blocked
+        std::mutex mutex;
+        std::condition_variable drained;
+        std::atomic<bool> waiting;
+
+        static void callback(void*, Uint8*, int);
+
+    public:
+        Audio();
+        ~Audio();
+
+        Audio(const Audio&) = delete;
+        Audio& operator=(const Audio&) = delete;
+
+        // Open the audio device. Returns false on failure.
+        bool setup();
+
+        // Sample rate the device was opened at
+        int sample_rate() const { return rate; }
+
+        // Queue a frame's interleaved stereo samples, dropping any that
+        // don't fit, and set the APU's rate for the next frame
+        void queue(const int16_t*, size_t, Apu&);
+
+        // Keep the APU at Apu::SAMPLE_RATE and resample its output instead
+        void set_resampling(bool);
+
+        // Stretch the output so each Game Boy frame lasts one refresh of
+        // a display at this rate. Ignored if that would change the pitch
+        // noticeably.
+        void match_display(double refresh_rate);
+
+        // Block until the device has played the ring down to half full
+        void wait();
+};
+
+#endif // AUDIO_HPP
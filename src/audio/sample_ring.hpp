@@ -0,0 +1,74 @@
+#ifndef SAMPLE_RING_HPP
+#define SAMPLE_RING_HPP
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Stereo sample ring
+// A lock-free single-producer, single-consumer ring of interleaved 16-bit
+// stereo samples. The emulation thread pushes each frame's samples and
+// the audio device's callback pops them, neither ever waiting on the
+// other. Positions count stereo samples.
+
+class SampleRing {
+    private:
+        std::vector<int16_t> samples;
+        size_t mask;
+
+        // Advanced by the consumer and the producer respectively, on
+        // separate cache lines
+        alignas(64) std::atomic<size_t> head;
+        alignas(64) std::atomic<size_t> tail;
+
+    public:
+        // capacity is rounded up to a power of two
+        SampleRing(size_t capacity) : head {0}, tail {0} {
+            size_t size = 1;
+            while (size < capacity) size <<= 1;
+            samples.resize(size * 2);
+            mask = size - 1;
+        }
+
+        SampleRing(const SampleRing&) = delete;
+        SampleRing& operator=(const SampleRing&) = delete;
+
+        size_t capacity() const { return mask + 1; }
+
+        // Samples queued. Exact for either side, a snapshot for others.
+        size_t size() const {
+            return tail.load(std::memory_order_acquire) -
+                   head.load(std::memory_order_acquire);
+        }
+
+        // Producer only. Queues as many of count samples as fit and
+        // returns how many.
+        size_t push(const int16_t* in, size_t count) {
+            size_t t = tail.load(std::memory_order_relaxed);
+            size_t space = capacity() - (t - head.load(std::memory_order_acquire));
+            count = std::min(count, space);
+            for (size_t i = 0; i < count; ++i) {
+                size_t index = ((t + i) & mask) * 2;
+                samples[index] = in[i * 2];
+                samples[index + 1] = in[i * 2 + 1];
+            }
+            tail.store(t + count, std::memory_order_release);
+            return count;
+        }
+
+        // Consumer only. Takes up to count samples and returns how many.
+        size_t pop(int16_t* out, size_t count) {
+            size_t h = head.load(std::memory_order_relaxed);
+            count = std::min(count, tail.load(std::memory_order_acquire) - h);
+            for (size_t i = 0; i < count; ++i) {
+                size_t index = ((h + i) & mask) * 2;
+                out[i * 2] = samples[index];
+                out[i * 2 + 1] = samples[index + 1];
+            }
+            head.store(h + count, std::memory_order_release);
+            return count;
+        }
+};
+
+#endif // SAMPLE_RING_HPP
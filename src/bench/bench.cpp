@@ -0,0 +1,145 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <memory>
+
+#include "workloads.hpp"
+#include "../gameboy.hpp"
+#include "../profile/perf_counters.hpp"
+
+// Benchmark harness
+// Runs each synthetic workload headlessly for a fixed number of frames,
+// then times the memory and rendering primitives on their own, and prints
+// the results as JSON. With --perf, each workload also reports hardware
+// counters per emulated instruction and per frame.
+//
+// Usage: rugbe-bench [--frames <count>] [--output <file>] [--perf]
+
+typedef std::chrono::steady_clock Clock;
+
+static double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Iterations for the micro-benchmarks
+const int MICRO_ITERATIONS = 1 << 22;
+
+int main(int argc, char** argv) {
+    int frames = 600;
+    const char* output = nullptr;
+    bool perf = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (std::strcmp(argv[i], "--perf") == 0) {
+            perf = true;
+        }
+    }
+
+    PerfCounters counters;
+    if (perf && !counters.open()) {
+        std::cerr << "Hardware counters are unavailable." << std::endl;
+        perf = false;
+    }
+
+    std::ostringstream json;
+    json << "{\n  \"frames\": " << frames << ",\n  \"workloads\": [";
+
+    std::vector<Workload> workloads = make_workloads();
+    for (size_t w = 0; w < workloads.size(); ++w) {
+        const Workload& workload = workloads[w];
+
+        auto gb = std::make_unique<GameBoy>();
+        gb->load_rom(workload.rom.data(), workload.rom.size());
+
+        if (perf) counters.start();
+        auto start = Clock::now();
+        for (int f = 0; f < frames; ++f) {
+            gb->emulate();
+        }
+        double seconds = seconds_since(start);
+        if (perf) counters.stop();
+        uint64_t instructions = gb->cpu.instructions;
+
+        json << (w ? "," : "") << "\n    {"
+             << "\"name\": \"" << workload.name << "\", "
+             << "\"seconds\": " << seconds << ", "
+             << "\"instructions\": " << instructions << ", "
+             << "\"instructions_per_sec\": " << instructions / seconds << ", "
+             << "\"frames_per_sec\": " << frames / seconds;
+
+        if (perf) {
+            json << ", \"perf\": {";
+            for (int i = 0; i < PERF_EVENTS; ++i) {
+                PerfEvent event = static_cast<PerfEvent>(i);
+                int64_t count = counters.read(event);
+                json << (i ? ", " : "") << "\"" << perf_event_name(event)
+                     << "\": ";
+                if (count < 0) {
+                    json << "null";
+                    continue;
+                }
+                json << "{\"total\": " << count << ", "
+                     << "\"per_instruction\": "
+                     << double(count) / instructions << ", "
+                     << "\"per_frame\": " << double(count) / frames << "}";
+            }
+            json << "}";
+        }
+        json << "}";
+    }
+    json << "\n  ],\n";
+
+    // Micro-benchmarks on a fresh machine
+    auto gb = std::make_unique<GameBoy>();
+    gb->load_rom(workloads.front().rom.data(), workloads.front().rom.size());
+
+    // Reads and writes spread over work RAM
+    uint32_t sum = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < MICRO_ITERATIONS; ++i) {
+        sum += gb->mmu.read(0xc000 + (i & 0x1fff));
+    }
+    double read_ns = seconds_since(start) * 1e9 / MICRO_ITERATIONS;
+
+    start = Clock::now();
+    for (int i = 0; i < MICRO_ITERATIONS; ++i) {
+        gb->mmu.write(0xc000 + (i & 0x1fff), i);
+    }
+    double write_ns = seconds_since(start) * 1e9 / MICRO_ITERATIONS;
+
+    // Render whole frames of a background with varied tiles
+    for (int addr = 0x8000; addr < 0xa000; ++addr) {
+        gb->mmu.write(addr, addr * 7);
+    }
+    int renders = MICRO_ITERATIONS / (64 * 144);
+    start = Clock::now();
+    for (int i = 0; i < renders; ++i) {
+        gb->ppu.render();
+    }
+    double render_ns = seconds_since(start) * 1e9 / (renders * 144);
+
+    json << "  \"micro\": {"
+         << "\"mmu_read_ns\": " << read_ns << ", "
+         << "\"mmu_write_ns\": " << write_ns << ", "
+         << "\"ppu_render_line_ns\": " << render_ns << "},\n"
+         << "  \"checksum\": " << (sum + gb->ppu.framebuffer[0]) << "\n}\n";
+
+    if (output) {
+        std::ofstream file(output);
+        file << json.str();
+        if (!file) {
+            std::cerr << "Failed to write " << output << std::endl;
+            return 1;
+        }
+    } else {
+        std::cout << json.str();
+    }
+
+    return 0;
+}
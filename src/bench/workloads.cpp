@@ -0,0 +1,117 @@
+#include "workloads.hpp"
+
+// Minimal assembler: emits bytes and resolves relative jumps
+class Assembler {
+    private:
+        std::vector<uint8_t> rom;
+
+    public:
+        Assembler() { rom.reserve(0x8000); }
+
+        uint16_t here() const { return rom.size(); }
+
+        void emit(std::initializer_list<uint8_t> bytes) {
+            rom.insert(rom.end(), bytes);
+        }
+
+        // JR to target; op is 0x18 (JR), 0x20 (JR NZ) or 0x28 (JR Z)
+        void jr(uint8_t op, uint16_t target) {
+            int offset = target - (here() + 2);
+            emit({op, static_cast<uint8_t>(static_cast<int8_t>(offset))});
+        }
+
+        std::vector<uint8_t> build() {
+            std::vector<uint8_t> image = rom;
+            image.resize(0x8000, 0x00);
+            return image;
+        }
+};
+
+const uint8_t JR    = 0x18;
+const uint8_t JR_NZ = 0x20;
+
+// Register arithmetic in a tight loop
+static std::vector<uint8_t> alu() {
+    Assembler a;
+    uint16_t loop = a.here();
+    a.emit({0x3c});         // INC A
+    a.emit({0x80});         // ADD A,B
+    a.emit({0xa9});         // XOR C
+    a.emit({0x05});         // DEC B
+    a.jr(JR_NZ, loop);
+    a.emit({0x0c});         // INC C
+    a.jr(JR, loop);
+    return a.build();
+}
+
+// Copy 256 bytes of work RAM at a time
+static std::vector<uint8_t> memcpy_loop() {
+    Assembler a;
+    uint16_t start = a.here();
+    a.emit({0x21, 0x00, 0xc0}); // LD HL,$c000
+    a.emit({0x11, 0x00, 0xd0}); // LD DE,$d000
+    a.emit({0x06, 0x00});       // LD B,0
+    uint16_t loop = a.here();
+    a.emit({0x2a});             // LD A,(HL+)
+    a.emit({0x12});             // LD (DE),A
+    a.emit({0x13});             // INC DE
+    a.emit({0x05});             // DEC B
+    a.jr(JR_NZ, loop);
+    a.jr(JR, start);
+    return a.build();
+}
+
+// Wait for LY to reach the first VBlank line, as most games do
+static std::vector<uint8_t> ly_poll() {
+    Assembler a;
+    uint16_t loop = a.here();
+    a.emit({0xf0, 0x44});       // LDH A,($44)
+    a.emit({0xfe, 0x90});       // CP $90
+    a.jr(JR_NZ, loop);
+    a.emit({0x04});             // INC B
+    a.jr(JR, loop);
+    return a.build();
+}
+
+// Fill all of VRAM over and over
+static std::vector<uint8_t> vram_upload() {
+    Assembler a;
+    uint16_t start = a.here();
+    a.emit({0x21, 0x00, 0x80}); // LD HL,$8000
+    a.emit({0x16, 0x20});       // LD D,$20
+    uint16_t outer = a.here();
+    a.emit({0x06, 0x00});       // LD B,0
+    uint16_t inner = a.here();
+    a.emit({0x22});             // LD (HL+),A
+    a.emit({0x3c});             // INC A
+    a.emit({0x05});             // DEC B
+    a.jr(JR_NZ, inner);
+    a.emit({0x15});             // DEC D
+    a.jr(JR_NZ, outer);
+    a.jr(JR, start);
+    return a.build();
+}
+
+// Idle in HALT, as games do while waiting for VBlank. With IME off,
+// HALT ends on the request without servicing it.
+static std::vector<uint8_t> halt_idle() {
+    Assembler a;
+    a.emit({0x3e, 0x01});       // LD A,$01
+    a.emit({0xe0, 0xff});       // LDH ($ff),A
+    uint16_t loop = a.here();
+    a.emit({0xaf});             // XOR A
+    a.emit({0xe0, 0x0f});       // LDH ($0f),A
+    a.emit({0x76});             // HALT
+    a.jr(JR, loop);
+    return a.build();
+}
+
+std::vector<Workload> make_workloads() {
+    return {
+        {"alu", alu()},
+        {"memcpy", memcpy_loop()},
+        {"ly_poll", ly_poll()},
+        {"vram_upload", vram_upload()},
+        {"halt_idle", halt_idle()}
+    };
+}
@@ -0,0 +1,19 @@
+#ifndef WORKLOADS_HPP
+#define WORKLOADS_HPP
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Synthetic benchmark ROMs
+// Each workload is a tiny hand-assembled program that loops forever at
+// $0000, padded to a 32 KB ROM image. They are generated here so that
+// benchmarking never needs a commercial ROM.
+
+struct Workload {
+    std::string name;
+    std::vector<uint8_t> rom;
+};
+
+std::vector<Workload> make_workloads();
+
+#endif // WORKLOADS_HPP
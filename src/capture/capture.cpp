@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include "capture.hpp"
+#include "../profile/zones.hpp"
+
+// How long the writer sleeps before checking for frames again, in case
+// it missed a wake-up
+const std::chrono::milliseconds POLL_INTERVAL(5);
+
+Capture::Capture(const char* video_path, const char* audio_path,
+                 int sample_rate, size_t count)
+    : head {0}, tail {0}, y4m {false}, sample_rate {sample_rate},
+      audio_bytes {0}, quit {false}, written {0}, dropped {0}
+{
+    size_t size = 1;
+    while (size < count) size <<= 1;
+    slots.resize(size);
+    mask = size - 1;
+    for (Slot& slot : slots) {
+        slot.samples.resize(FRAME_SAMPLES * 2);
+        slot.count = 0;
+    }
+
+    if (video_path) {
+        video.open(video_path, std::ios::binary | std::ios::trunc);
+        size_t length = std::strlen(video_path);
+        y4m = length >= 4 && std::strcmp(video_path + length - 4, ".y4m") == 0;
+
+        // 4:4:4, so no chroma subsampling, at exactly the DMG frame rate
+        if (y4m) video << "YUV4MPEG2 W160 H144 F4194304:70224 Ip A1:1 C444\n";
+        scratch.resize(160 * 144 * (y4m ? 3 : 4));
+    }
+    if (audio_path) {
+        audio.open(audio_path, std::ios::binary | std::ios::trunc);
+        write_wav_header();
+    }
+
+    thread = std::thread(&Capture::run, this);
+}
+
+Capture::~Capture() {
+    finish();
+}
+
+void Capture::finish() {
+    if (!thread.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+bool Capture::valid() const {
+    return !video.fail() && !audio.fail();
+}
+
+void Capture::push(const std::array<Pixel, 160 * 144>& frame,
+                   const int16_t* samples, size_t count) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) > mask) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Slot& slot = slots[t & mask];
+    slot.frame = frame;
+    slot.count = std::min(count, FRAME_SAMPLES);
+    std::copy(samples, samples + slot.count * 2, slot.samples.begin());
+    tail.store(t + 1, std::memory_order_release);
+
+    // Without the lock this can be missed, which only delays the writer
+    // until its next poll
+    wake.notify_one();
+}
+
+void Capture::run() {
+    name_zone_thread("capture");
+
+    while (true) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            // Only stop once everything pushed before quit is written
+            std::unique_lock<std::mutex> lock(mutex);
+            if (quit) break;
+            wake.wait_for(lock, POLL_INTERVAL);
+            continue;
+        }
+
+        write(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // Fill in the sizes now that they are known
+    if (audio.is_open()) write_wav_header();
+}
+
+void Capture::write(const Slot& slot) {
+    ZONE("capture");
+
+    if (video.is_open()) {
+        uint8_t* out = scratch.data();
+        const size_t pixels = 160 * 144;
+        for (size_t i = 0; i < pixels; ++i) {
+            uint32_t p = slot.frame[i];
+            int r = (p >> 16) & 0xff;
+            int g = (p >> 8) & 0xff;
+            int b = p & 0xff;
+
+            if (y4m) {
+                // BT.601, limited range, in planes
+                out[i] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+                out[pixels + i] = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+                out[pixels * 2 + i] = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+            } else {
+                out[i * 4] = r;
+                out[i * 4 + 1] = g;
+                out[i * 4 + 2] = b;
+                out[i * 4 + 3] = p >> 24;
+            }
+        }
+
+        if (y4m) video << "FRAME\n";
+        video.write(reinterpret_cast<const char*>(out), scratch.size());
+    }
+
+    if (audio.is_open()) {
+        audio.write(reinterpret_cast<const char*>(slot.samples.data()),
+                    slot.count * 2 * sizeof(int16_t));
+        audio_bytes += slot.count * 2 * sizeof(int16_t);
+    }
+
+    written.fetch_add(1, std::memory_order_relaxed);
+}
+
+// 44-byte PCM header: RIFF chunk, format chunk, then the data chunk's
+// header. Written with zero sizes first and again once they are known.
+void Capture::write_wav_header() {
+    struct WavHeader {
+        char     riff[4];
+        uint32_t riff_size;
+        char     wave[4];
+        char     fmt[4];
+        uint32_t fmt_size;
+        uint16_t format;
+        uint16_t channels;
+        uint32_t sample_rate;
+        uint32_t byte_rate;
+        uint16_t block_align;
+        uint16_t bits;
+        char     data[4];
+        uint32_t data_size;
+    };
+
+    WavHeader header {{'R', 'I', 'F', 'F'}, 36 + audio_bytes,
+                      {'W', 'A', 'V', 'E'}, {'f', 'm', 't', ' '}, 16, 1, 2,
+                      uint32_t(sample_rate), uint32_t(sample_rate) * 4, 4, 16,
+                      {'d', 'a', 't', 'a'}, audio_bytes};
+
+    audio.seekp(0);
+    audio.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    audio.seekp(0, std::ios::end);
+}
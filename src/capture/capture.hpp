@@ -0,0 +1,89 @@
+#ifndef CAPTURE_HPP
+#define CAPTURE_HPP
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../ppu/ppu.hpp"
+
+// Audio/video capture
+// Streams frames, as Y4M or raw RGBA, and samples, as a 16-bit stereo
+// WAV, to disk from a writer thread. The emulation thread only copies
+// each frame and its samples into a free slot of a preallocated ring and
+// moves on; it never waits on the writer or the disk. When every slot is
+// still waiting to be written, the frame is dropped and counted instead.
+
+class Capture {
+    private:
+        struct Slot {
+            std::array<Pixel, 160 * 144> frame;
+            std::vector<int16_t> samples;
+            size_t count;
+        };
+
+        std::vector<Slot> slots;
+        size_t mask;
+
+        // Advanced by the writer and the emulation thread respectively,
+        // on separate cache lines
+        alignas(64) std::atomic<size_t> head;
+        alignas(64) std::atomic<size_t> tail;
+
+        std::ofstream video;
+        std::ofstream audio;
+        bool y4m;
+        int sample_rate;
+        uint32_t audio_bytes;
+
+        // Frame converted for writing
+        std::vector<uint8_t> scratch;
+
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool quit;
+
+        std::atomic<uint64_t> written;
+        std::atomic<uint64_t> dropped;
+
+        void run();
+        void write(const Slot&);
+        void write_wav_header();
+
+    public:
+        // Stereo samples each frame can hold; more are cut off
+        static constexpr size_t FRAME_SAMPLES = 2048;
+
+        // Either path may be null to capture only the other. A video path
+        // ending in .y4m is written as Y4M, any other as raw RGBA.
+        Capture(const char* video_path, const char* audio_path,
+                int sample_rate, size_t slots = 16);
+
+        // Calls finish()
+        ~Capture();
+
+        Capture(const Capture&) = delete;
+        Capture& operator=(const Capture&) = delete;
+
+        // False if a file couldn't be created
+        bool valid() const;
+
+        // Emulation thread. Queue a frame with its interleaved stereo
+        // samples, or drop it if the writer is behind.
+        void push(const std::array<Pixel, 160 * 144>&, const int16_t*, size_t);
+
+        // Write out the frames still queued and stop the writer. Nothing
+        // may be pushed after this.
+        void finish();
+
+        uint64_t frames_written() const { return written.load(); }
+        uint64_t frames_dropped() const { return dropped.load(); }
+};
+
+#endif // CAPTURE_HPP
@@ -1,13 +1,102 @@
 #include "cpu.hpp"
 #include "../mmu/mmu.hpp"
 #include "../ppu/ppu.hpp"
+#include "../state/state.hpp"
+#include "../trace/trace.hpp"
 
 // Initialize CPU
-Cpu::Cpu(Mmu* mmu, Ppu* ppu) : cycles {0}, mmu {mmu}, ppu {ppu}, pc {0}, sp {0xfffe} {}
+Cpu::Cpu(Mmu* mmu, Ppu* ppu) : cycles {0}, clock_base {0}, instructions {0}, halted_cycles {0}, ime {false}, halted {false}, halt_bug {false}, tracer {nullptr}, mmu {mmu}, ppu {ppu}, pc {0}, sp {0xfffe}, ei_delay {0}, pending {0}, attention {false} {}
 
-// Dispatch cycles to other components
-void Cpu::dispatch_cycles() {
-    ppu->cycles = cycles;
+void Cpu::save_state(CpuState& state) {
+    state.af = reg.af();
+    state.bc = reg.bc();
+    state.de = reg.de();
+    state.hl = reg.hl();
+    state.sp = sp;
+    state.pc = pc;
+    state.cycles = cycles;
+    state.ime = ime;
+    state.halted = halted;
+    state.ei_delay = ei_delay;
+    state.halt_bug = halt_bug;
+}
+
+void Cpu::load_state(const CpuState& state) {
+    reg.af() = state.af;
+    reg.bc() = state.bc;
+    reg.de() = state.de;
+    reg.hl() = state.hl;
+    sp = state.sp;
+    pc = state.pc;
+    cycles = state.cycles;
+    ime = state.ime;
+    halted = state.halted;
+    ei_delay = state.ei_delay;
+    halt_bug = state.halt_bug;
+    update_interrupts();
+}
+
+void Cpu::update_interrupts() {
+    pending = mmu->at(0xffff) & mmu->at(0xff0f) & 0x1f;
+    attention = (pending && ime) || halted || ei_delay;
+}
+
+bool Cpu::check_interrupts() {
+    // EI takes effect once the instruction after it has executed
+    if (ei_delay && --ei_delay == 0) {
+        ime = true;
+    }
+
+    // A requested interrupt ends HALT even if it can't be serviced
+    if (pending) {
+        halted = false;
+        if (ime) {
+            service_interrupt();
+            return true;
+        }
+    }
+
+    if (halted) {
+        cycles += 4;
+        halted_cycles += 4;
+        return true;
+    }
+
+    update_interrupts();
+    return false;
+}
+
+// Takes 20 cycles
+void Cpu::service_interrupt() {
+    // Lowest bit has the highest priority; its vector is $40 + 8 * bit
+    int bit = 0;
+    while (!(pending & (1 << bit))) ++bit;
+
+    ime = false;
+    mmu->clear_interrupt(1 << bit);
+
+    push((pc >> 8) & 0xff, pc & 0xff);
+    pc = 0x40 + 8 * bit;
+    cycles += 12;
+
+    update_interrupts();
+}
+
+// Record the instruction about to execute
+void Cpu::trace() {
+    TraceRecord& record = tracer->next();
+    record.pc = pc;
+    record.sp = sp;
+    record.af = reg.af();
+    record.bc = reg.bc();
+    record.de = reg.de();
+    record.hl = reg.hl();
+    for (int k = 0; k < 3; ++k) {
+        record.bytes[k] = mmu->at((pc + k) & 0xffff);
+    }
+    record.reserved = 0;
+    record.cycles = cycles;
+    tracer->commit();
 }
 
 // Get immediate 8-bit data
@@ -37,8 +126,28 @@ void Cpu::execute_instruction() {
     // Increment PC by default. Some instructions may set this to false.
     increment_pc = true;
 
+    if (attention && check_interrupts()) return;
+
+    if (tracer) trace();
+
+#ifdef RUGBE_PROFILE
+    uint16_t start_pc = pc;
+    int start_cycles = cycles;
+#endif
+
     uint8_t op = mmu->read(pc);
 
+    // After the HALT bug, PC isn't advanced past this opcode, so the
+    // byte is read again as the instruction's next byte
+    if (halt_bug) {
+        halt_bug = false;
+        --pc;
+    }
+
+#ifdef RUGBE_PROFILE
+    uint16_t profile_op = op;
+#endif
+
     switch (op) {
         case 0x00: break; // NOP
         case 0x01: LD_rr_nn(reg.bc()); break;
@@ -158,7 +267,7 @@ void Cpu::execute_instruction() {
         case 0x73: LD_xxp_x(reg.hl(), reg.e()); break;
         case 0x74: LD_xxp_x(reg.hl(), reg.h()); break;
         case 0x75: LD_xxp_x(reg.hl(), reg.l()); break;
-        case 0x76: break; // TODO: HALT
+        case 0x76: HALT(); break;
         case 0x77: LD_xxp_x(reg.hl(), reg.a()); break;
         case 0x78: LD_r_x(reg.a(), reg.b()); break;
         case 0x79: LD_r_x(reg.a(), reg.c()); break;
@@ -246,6 +355,9 @@ void Cpu::execute_instruction() {
         case 0xcb: 
             ++pc;
             op = mmu->read(pc);
+#ifdef RUGBE_PROFILE
+            profile_op = 0x100 | op;
+#endif
             switch (op) {
                 case 0x00: RLC_r(reg.b()); break;
                 case 0x01: RLC_r(reg.c()); break;
@@ -508,7 +620,7 @@ void Cpu::execute_instruction() {
         case 0xcc: CALL_nn(reg.get_zf()); break;
         case 0xcd: CALL_nn(); break;
         case 0xce: ADC_a_x(get_n()); break;
-        case 0xcf: RST_h(8); break;
+        case 0xcf: RST_h(0x08); break;
         case 0xd0: RET_c(!reg.get_cf()); break;
         case 0xd1: POP_rr(reg.d(), reg.e()); break;
         case 0xd2: JP_nn(!reg.get_cf()); break;
@@ -516,7 +628,7 @@ void Cpu::execute_instruction() {
         case 0xd4: CALL_nn(!reg.get_cf()); break;
         case 0xd5: PUSH_rr(reg.d(), reg.e()); break;
         case 0xd6: SUB_a_x(get_n()); break;
-        case 0xd7: RST_h(10); break;
+        case 0xd7: RST_h(0x10); break;
         case 0xd8: RET_c(reg.get_cf()); break;
         case 0xd9: RETI(); break;
         case 0xda: JP_nn(reg.get_zf()); break;
@@ -524,7 +636,7 @@ void Cpu::execute_instruction() {
         case 0xdc: CALL_nn(reg.get_cf()); break;
         case 0xdd: break;
         case 0xde: SBC_a_x(get_n()); break;
-        case 0xdf: RST_h(18); break;
+        case 0xdf: RST_h(0x18); break;
         case 0xe0: LDH_np_a(); break;
         case 0xe1: POP_rr(reg.h(), reg.l()); break;
         case 0xe2: LD_cp_a(); break;
@@ -532,7 +644,7 @@ void Cpu::execute_instruction() {
         case 0xe4: break;
         case 0xe5: PUSH_rr(reg.h(), reg.l()); break;
         case 0xe6: AND_a_x(get_n()); break;
-        case 0xe7: RST_h(20); break;
+        case 0xe7: RST_h(0x20); break;
         case 0xe8: ADD_sp_i(); break;
         case 0xe9: JP_hl(); break;
         case 0xea: LD_xxp_x(get_nn(), reg.a()); break;
@@ -540,24 +652,27 @@ void Cpu::execute_instruction() {
         case 0xec: break;
         case 0xed: break;
         case 0xee: XOR_a_x(get_n()); break;
-        case 0xef: RST_h(28); break;
+        case 0xef: RST_h(0x28); break;
         case 0xf0: LDH_a_np(); break;
         case 0xf1: POP_rr(reg.a(), reg.f()); break;
         case 0xf2: LD_a_cp(); break;
-        case 0xf3: break; // TODO: DI
+        case 0xf3: DI(); break;
         case 0xf4: break;
         case 0xf5: PUSH_rr(reg.a(), reg.f()); break;
         case 0xf6: OR_a_x(get_n()); break;
-        case 0xf7: RST_h(30); break;
+        case 0xf7: RST_h(0x30); break;
         case 0xf8: LD_rr_rri(reg.hl(), sp); break;
         case 0xf9: LD_rr_rr(sp, reg.hl()); break;
         case 0xfa: LD_r_x(reg.a(), mmu->read(get_nn())); break;
-        case 0xfb: break; // TODO: EI
+        case 0xfb: EI(); break;
         case 0xfc: break;
         case 0xfd: break;
         case 0xfe: CP_a_x(get_n()); break;
-        case 0xff: RST_h(38); break;
+        case 0xff: RST_h(0x38); break;
     }
     if (increment_pc) ++pc;
-    dispatch_cycles();
+    ++instructions;
+#ifdef RUGBE_PROFILE
+    profiler.record(start_pc, profile_op, cycles - start_cycles);
+#endif
 }
\ No newline at end of file
@@ -4,8 +4,13 @@
 #include <cstdint>
 
 #include "registers.hpp"
+#ifdef RUGBE_PROFILE
+#include "../profile/profiler.hpp"
+#endif
 class Mmu;
 class Ppu;
+class Tracer;
+struct CpuState;
 
 class Cpu {
     public:
@@ -14,8 +19,47 @@ class Cpu {
         void load_rom(const char* filepath);
         void execute_instruction();
         void disassemble_op();
+
+        // Cycles into the current frame, reset by GameBoy::begin_frame
         int cycles;
 
+        // Cycles of the frames before this one
+        uint64_t clock_base;
+
+        // Monotonic cycle count, for timers
+        uint64_t clock() const { return clock_base + cycles; }
+
+        // Instructions executed since power-on, for benchmarking
+        uint64_t instructions;
+
+        // Cycles spent halted since power-on
+        uint64_t halted_cycles;
+
+        // Interrupt master enable
+        bool ime;
+
+        // Set by HALT until an enabled interrupt is requested
+        bool halted;
+
+        // Set by HALT when it ends at once with IME off: the next opcode
+        // byte is read twice
+        bool halt_bug;
+
+        // Recompute the pending interrupts. Must be called whenever IE,
+        // IF or IME change; the MMU does so for writes and requests.
+        void update_interrupts();
+
+#ifdef RUGBE_PROFILE
+        Profiler profiler;
+#endif
+
+        // Records every instruction executed when set
+        Tracer* tracer;
+
+        // Copy registers and counters to/from a save state
+        void save_state(CpuState&);
+        void load_state(const CpuState&);
+
     private:
         Mmu* mmu;
         Ppu* ppu;
@@ -24,8 +68,26 @@ class Cpu {
         Registers reg;
         uint16_t sp;
 
-        // Dispatch cycles to other components
-        void dispatch_cycles();
+        // Instructions left until EI takes effect, 0 if none
+        uint8_t ei_delay;
+
+        // Requested and enabled interrupts (IE & IF & 0x1f), cached by
+        // update_interrupts() rather than tested after every instruction
+        uint8_t pending;
+
+        // Set while an interrupt can be serviced, the CPU is halted or
+        // EI is counting down: the only check on the per-instruction path
+        bool attention;
+
+        // Handle the above before an instruction. Returns true if the
+        // step was spent servicing an interrupt or halted.
+        bool check_interrupts();
+
+        // Push PC and jump to the vector of the highest priority interrupt
+        void service_interrupt();
+
+        // Write a trace record for the instruction at pc
+        void trace();
 
         // Retrieve values frequently accessed by instructions
         uint8_t get_n();
@@ -95,6 +157,11 @@ class Cpu {
         void RET_c(bool);
         void RST_h(int);
 
+        // interrupts
+        void DI();
+        void EI();
+        void HALT();
+
         // bit shift
         void RLC_r(uint8_t&);
         void RLC_hlp();
@@ -0,0 +1,30 @@
+#ifndef DISASSEMBLER_HPP
+#define DISASSEMBLER_HPP
+#include <cstddef>
+#include <cstdint>
+
+#include "opcodes.hpp"
+
+// Disassembler
+// Formats instructions from the opcode table into caller-provided
+// buffers, without allocating, so it is cheap enough for tracing and for
+// disassembling whole ROMs.
+
+// Buffer size that holds any instruction disassemble() writes
+const size_t DISASSEMBLY_SIZE = 24;
+
+// Write the mnemonic of the instruction in bytes (at least 3 bytes) into
+// buffer, NUL-terminated. addr is where the instruction is located, for
+// printing relative jump targets. Returns the number of characters
+// written, not counting the NUL.
+size_t disassemble(char* buffer, const uint8_t* bytes, uint16_t addr = 0);
+
+// Disassemble a ROM linearly from offset, one instruction per line:
+//   bank:addr  bytes     mnemonic
+// Writes as many whole lines as fit in buffer, advances offset past them
+// and returns the number of characters written. Call it again until
+// offset reaches size.
+size_t disassemble_rom(const uint8_t* rom, size_t size, size_t& offset,
+                       char* buffer, size_t buffer_size);
+
+#endif // DISASSEMBLER_HPP
@@ -418,7 +418,7 @@ void Cpu::CALL_nn(bool c) {
         ++pc;
         uint8_t lowpc = pc & 0xff;
         uint8_t highpc = (pc >> 8) & 0xff;
-        push(lowpc, highpc);
+        push(highpc, lowpc);
         pc = nn;
         increment_pc = false;
     }
@@ -427,20 +427,18 @@ void Cpu::CALL_nn(bool c) {
 // Takes 16 cycles
 void Cpu::RET() {
     uint8_t lowpc = 0, highpc = 0;
-    pop(lowpc, highpc);
+    pop(highpc, lowpc);
     pc = (highpc << 8) | lowpc;
     increment_pc = false;
     cycles += 4;
 }
 
-// Takes 16 cycles
-// TODO: Add interrupt support
+// Takes 16 cycles. Unlike EI, enables interrupts immediately.
 void Cpu::RETI() {
-    uint8_t lowpc = 0, highpc = 0;
-    pop(lowpc, highpc);
-    pc = (highpc << 8) | lowpc;
-    increment_pc = false;
-    cycles += 4;
+    RET();
+    ime = true;
+    ei_delay = 0;
+    update_interrupts();
 }
 
 // Takes 20 cycles if true, 8 if false
@@ -454,9 +452,10 @@ void Cpu::RET_c(bool c) {
 
 // Takes 16 cycles
 void Cpu::RST_h(int h) {
+    ++pc;
     uint8_t lowpc = pc & 0xff;
     uint8_t highpc = (pc >> 8) & 0xff;
-    push(lowpc, highpc);
+    push(highpc, lowpc);
     pc = h;
     increment_pc = false;
 
@@ -464,6 +463,37 @@ void Cpu::RST_h(int h) {
 }
 
 
+/*************************
+ *      interrupts
+ *************************/
+
+void Cpu::DI() {
+    ime = false;
+    ei_delay = 0;
+    update_interrupts();
+}
+
+// IME is set after the next instruction, so EI followed by RET returns
+// before any interrupt is serviced
+void Cpu::EI() {
+    if (!ime) ei_delay = 2;
+    update_interrupts();
+}
+
+// Wait, without executing, until an enabled interrupt is requested.
+// With IME off and an interrupt already pending, HALT doesn't wait at all,
+// and the CPU then fails to advance PC past the next opcode (the HALT
+// bug). An EI just before still counts as IME on here.
+void Cpu::HALT() {
+    if (pending && !ime && !ei_delay) {
+        halt_bug = true;
+        return;
+    }
+    halted = true;
+    update_interrupts();
+}
+
+
 /*************************
  *      bit shift
  *************************/
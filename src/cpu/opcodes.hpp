@@ -0,0 +1,554 @@
+#ifndef OPCODES_HPP
+#define OPCODES_HPP
+#include <cstdint>
+
+// Opcode metadata
+// One entry per opcode, 0x00-0xff followed by the CB-prefixed opcodes at
+// 0x100-0x1ff (the same indexing as the profiler). The disassembler
+// formats instructions from it, and anything that needs an instruction's
+// length or timing without executing it can look it up here.
+
+// The operand following an opcode, and how it is printed
+enum class Operand: uint8_t {
+    NONE,
+    U8,     // n, as $xx
+    U16,    // nn, as $xxxx
+    REL,    // i, a relative jump, as the target address
+    S8      // i, a signed offset, as +$xx or -$xx
+};
+
+struct Opcode {
+    // Mnemonic, with '*' where the operand is printed
+    const char* mnemonic;
+
+    // Length in bytes, including the CB prefix
+    uint8_t length;
+    Operand operand;
+
+    // Cycles taken. Conditional jumps, calls and returns take
+    // cycles_taken instead when the condition holds.
+    uint8_t cycles;
+    uint8_t cycles_taken;
+};
+
+inline constexpr Opcode OPCODES[512] = {
+    {"NOP", 1, Operand::NONE, 4, 4},                // 00
+    {"LD    BC,*", 3, Operand::U16, 12, 12},        // 01
+    {"LD    (BC),A", 1, Operand::NONE, 8, 8},       // 02
+    {"INC   BC", 1, Operand::NONE, 8, 8},           // 03
+    {"INC   B", 1, Operand::NONE, 4, 4},            // 04
+    {"DEC   B", 1, Operand::NONE, 4, 4},            // 05
+    {"LD    B,*", 2, Operand::U8, 8, 8},            // 06
+    {"RLCA", 1, Operand::NONE, 4, 4},               // 07
+    {"LD    (*),SP", 3, Operand::U16, 20, 20},      // 08
+    {"ADD   HL,BC", 1, Operand::NONE, 8, 8},        // 09
+    {"LD    A,(BC)", 1, Operand::NONE, 8, 8},       // 0a
+    {"DEC   BC", 1, Operand::NONE, 8, 8},           // 0b
+    {"INC   C", 1, Operand::NONE, 4, 4},            // 0c
+    {"DEC   C", 1, Operand::NONE, 4, 4},            // 0d
+    {"LD    C,*", 2, Operand::U8, 8, 8},            // 0e
+    {"RRCA", 1, Operand::NONE, 4, 4},               // 0f
+    {"STOP  0", 2, Operand::NONE, 4, 4},            // 10
+    {"LD    DE,*", 3, Operand::U16, 12, 12},        // 11
+    {"LD    (DE),A", 1, Operand::NONE, 8, 8},       // 12
+    {"INC   DE", 1, Operand::NONE, 8, 8},           // 13
+    {"INC   D", 1, Operand::NONE, 4, 4},            // 14
+    {"DEC   D", 1, Operand::NONE, 4, 4},            // 15
+    {"LD    D,*", 2, Operand::U8, 8, 8},            // 16
+    {"RLA", 1, Operand::NONE, 4, 4},                // 17
+    {"JR    *", 2, Operand::REL, 12, 12},           // 18
+    {"ADD   HL,DE", 1, Operand::NONE, 8, 8},        // 19
+    {"LD    A,(DE)", 1, Operand::NONE, 8, 8},       // 1a
+    {"DEC   DE", 1, Operand::NONE, 8, 8},           // 1b
+    {"INC   E", 1, Operand::NONE, 4, 4},            // 1c
+    {"DEC   E", 1, Operand::NONE, 4, 4},            // 1d
+    {"LD    E,*", 2, Operand::U8, 8, 8},            // 1e
+    {"RRA", 1, Operand::NONE, 4, 4},                // 1f
+    {"JR    NZ,*", 2, Operand::REL, 8, 12},         // 20
+    {"LD    HL,*", 3, Operand::U16, 12, 12},        // 21
+    {"LD    (HL+),A", 1, Operand::NONE, 8, 8},      // 22
+    {"INC   HL", 1, Operand::NONE, 8, 8},           // 23
+    {"INC   H", 1, Operand::NONE, 4, 4},            // 24
+    {"DEC   H", 1, Operand::NONE, 4, 4},            // 25
+    {"LD    H,*", 2, Operand::U8, 8, 8},            // 26
+    {"DAA", 1, Operand::NONE, 4, 4},                // 27
+    {"JR    Z,*", 2, Operand::REL, 8, 12},          // 28
+    {"ADD   HL,HL", 1, Operand::NONE, 8, 8},        // 29
+    {"LD    A,(HL+)", 1, Operand::NONE, 8, 8},      // 2a
+    {"DEC   HL", 1, Operand::NONE, 8, 8},           // 2b
+    {"INC   L", 1, Operand::NONE, 4, 4},            // 2c
+    {"DEC   L", 1, Operand::NONE, 4, 4},            // 2d
+    {"LD    L,*", 2, Operand::U8, 8, 8},            // 2e
+    {"CPL", 1, Operand::NONE, 4, 4},                // 2f
+    {"JR    NC,*", 2, Operand::REL, 8, 12},         // 30
+    {"LD    SP,*", 3, Operand::U16, 12, 12},        // 31
+    {"LD    (HL-),A", 1, Operand::NONE, 8, 8},      // 32
+    {"INC   SP", 1, Operand::NONE, 8, 8},           // 33
+    {"INC   (HL)", 1, Operand::NONE, 12, 12},       // 34
+    {"DEC   (HL)", 1, Operand::NONE, 12, 12},       // 35
+    {"LD    (HL),*", 2, Operand::U8, 12, 12},       // 36
+    {"SCF", 1, Operand::NONE, 4, 4},                // 37
+    {"JR    C,*", 2, Operand::REL, 8, 12},          // 38
+    {"ADD   HL,SP", 1, Operand::NONE, 8, 8},        // 39
+    {"LD    A,(HL-)", 1, Operand::NONE, 8, 8},      // 3a
+    {"DEC   SP", 1, Operand::NONE, 8, 8},           // 3b
+    {"INC   A", 1, Operand::NONE, 4, 4},            // 3c
+    {"DEC   A", 1, Operand::NONE, 4, 4},            // 3d
+    {"LD    A,*", 2, Operand::U8, 8, 8},            // 3e
+    {"CCF", 1, Operand::NONE, 4, 4},                // 3f
+    {"LD    B,B", 1, Operand::NONE, 4, 4},          // 40
+    {"LD    B,C", 1, Operand::NONE, 4, 4},          // 41
+    {"LD    B,D", 1, Operand::NONE, 4, 4},          // 42
+    {"LD    B,E", 1, Operand::NONE, 4, 4},          // 43
+    {"LD    B,H", 1, Operand::NONE, 4, 4},          // 44
+    {"LD    B,L", 1, Operand::NONE, 4, 4},          // 45
+    {"LD    B,(HL)", 1, Operand::NONE, 8, 8},       // 46
+    {"LD    B,A", 1, Operand::NONE, 4, 4},          // 47
+    {"LD    C,B", 1, Operand::NONE, 4, 4},          // 48
+    {"LD    C,C", 1, Operand::NONE, 4, 4},          // 49
+    {"LD    C,D", 1, Operand::NONE, 4, 4},          // 4a
+    {"LD    C,E", 1, Operand::NONE, 4, 4},          // 4b
+    {"LD    C,H", 1, Operand::NONE, 4, 4},          // 4c
+    {"LD    C,L", 1, Operand::NONE, 4, 4},          // 4d
+    {"LD    C,(HL)", 1, Operand::NONE, 8, 8},       // 4e
+    {"LD    C,A", 1, Operand::NONE, 4, 4},          // 4f
+    {"LD    D,B", 1, Operand::NONE, 4, 4},          // 50
+    {"LD    D,C", 1, Operand::NONE, 4, 4},          // 51
+    {"LD    D,D", 1, Operand::NONE, 4, 4},          // 52
+    {"LD    D,E", 1, Operand::NONE, 4, 4},          // 53
+    {"LD    D,H", 1, Operand::NONE, 4, 4},          // 54
+    {"LD    D,L", 1, Operand::NONE, 4, 4},          // 55
+    {"LD    D,(HL)", 1, Operand::NONE, 8, 8},       // 56
+    {"LD    D,A", 1, Operand::NONE, 4, 4},          // 57
+    {"LD    E,B", 1, Operand::NONE, 4, 4},          // 58
+    {"LD    E,C", 1, Operand::NONE, 4, 4},          // 59
+    {"LD    E,D", 1, Operand::NONE, 4, 4},          // 5a
+    {"LD    E,E", 1, Operand::NONE, 4, 4},          // 5b
+    {"LD    E,H", 1, Operand::NONE, 4, 4},          // 5c
+    {"LD    E,L", 1, Operand::NONE, 4, 4},          // 5d
+    {"LD    E,(HL)", 1, Operand::NONE, 8, 8},       // 5e
+    {"LD    E,A", 1, Operand::NONE, 4, 4},          // 5f
+    {"LD    H,B", 1, Operand::NONE, 4, 4},          // 60
+    {"LD    H,C", 1, Operand::NONE, 4, 4},          // 61
+    {"LD    H,D", 1, Operand::NONE, 4, 4},          // 62
+    {"LD    H,E", 1, Operand::NONE, 4, 4},          // 63
+    {"LD    H,H", 1, Operand::NONE, 4, 4},          // 64
+    {"LD    H,L", 1, Operand::NONE, 4, 4},          // 65
+    {"LD    H,(HL)", 1, Operand::NONE, 8, 8},       // 66
+    {"LD    H,A", 1, Operand::NONE, 4, 4},          // 67
+    {"LD    L,B", 1, Operand::NONE, 4, 4},          // 68
+    {"LD    L,C", 1, Operand::NONE, 4, 4},          // 69
+    {"LD    L,D", 1, Operand::NONE, 4, 4},          // 6a
+    {"LD    L,E", 1, Operand::NONE, 4, 4},          // 6b
+    {"LD    L,H", 1, Operand::NONE, 4, 4},          // 6c
+    {"LD    L,L", 1, Operand::NONE, 4, 4},          // 6d
+    {"LD    L,(HL)", 1, Operand::NONE, 8, 8},       // 6e
+    {"LD    L,A", 1, Operand::NONE, 4, 4},          // 6f
+    {"LD    (HL),B", 1, Operand::NONE, 8, 8},       // 70
+    {"LD    (HL),C", 1, Operand::NONE, 8, 8},       // 71
+    {"LD    (HL),D", 1, Operand::NONE, 8, 8},       // 72
+    {"LD    (HL),E", 1, Operand::NONE, 8, 8},       // 73
+    {"LD    (HL),H", 1, Operand::NONE, 8, 8},       // 74
+    {"LD    (HL),L", 1, Operand::NONE, 8, 8},       // 75
+    {"HALT", 1, Operand::NONE, 4, 4},               // 76
+    {"LD    (HL),A", 1, Operand::NONE, 8, 8},       // 77
+    {"LD    A,B", 1, Operand::NONE, 4, 4},          // 78
+    {"LD    A,C", 1, Operand::NONE, 4, 4},          // 79
+    {"LD    A,D", 1, Operand::NONE, 4, 4},          // 7a
+    {"LD    A,E", 1, Operand::NONE, 4, 4},          // 7b
+    {"LD    A,H", 1, Operand::NONE, 4, 4},          // 7c
+    {"LD    A,L", 1, Operand::NONE, 4, 4},          // 7d
+    {"LD    A,(HL)", 1, Operand::NONE, 8, 8},       // 7e
+    {"LD    A,A", 1, Operand::NONE, 4, 4},          // 7f
+    {"ADD   A,B", 1, Operand::NONE, 4, 4},          // 80
+    {"ADD   A,C", 1, Operand::NONE, 4, 4},          // 81
+    {"ADD   A,D", 1, Operand::NONE, 4, 4},          // 82
+    {"ADD   A,E", 1, Operand::NONE, 4, 4},          // 83
+    {"ADD   A,H", 1, Operand::NONE, 4, 4},          // 84
+    {"ADD   A,L", 1, Operand::NONE, 4, 4},          // 85
+    {"ADD   A,(HL)", 1, Operand::NONE, 8, 8},       // 86
+    {"ADD   A,A", 1, Operand::NONE, 4, 4},          // 87
+    {"ADC   A,B", 1, Operand::NONE, 4, 4},          // 88
+    {"ADC   A,C", 1, Operand::NONE, 4, 4},          // 89
+    {"ADC   A,D", 1, Operand::NONE, 4, 4},          // 8a
+    {"ADC   A,E", 1, Operand::NONE, 4, 4},          // 8b
+    {"ADC   A,H", 1, Operand::NONE, 4, 4},          // 8c
+    {"ADC   A,L", 1, Operand::NONE, 4, 4},          // 8d
+    {"ADC   A,(HL)", 1, Operand::NONE, 8, 8},       // 8e
+    {"ADC   A,A", 1, Operand::NONE, 4, 4},          // 8f
+    {"SUB   B", 1, Operand::NONE, 4, 4},            // 90
+    {"SUB   C", 1, Operand::NONE, 4, 4},            // 91
+    {"SUB   D", 1, Operand::NONE, 4, 4},            // 92
+    {"SUB   E", 1, Operand::NONE, 4, 4},            // 93
+    {"SUB   H", 1, Operand::NONE, 4, 4},            // 94
+    {"SUB   L", 1, Operand::NONE, 4, 4},            // 95
+    {"SUB   (HL)", 1, Operand::NONE, 8, 8},         // 96
+    {"SUB   A", 1, Operand::NONE, 4, 4},            // 97
+    {"SBC   A,B", 1, Operand::NONE, 4, 4},          // 98
+    {"SBC   A,C", 1, Operand::NONE, 4, 4},          // 99
+    {"SBC   A,D", 1, Operand::NONE, 4, 4},          // 9a
+    {"SBC   A,E", 1, Operand::NONE, 4, 4},          // 9b
+    {"SBC   A,H", 1, Operand::NONE, 4, 4},          // 9c
+    {"SBC   A,L", 1, Operand::NONE, 4, 4},          // 9d
+    {"SBC   A,(HL)", 1, Operand::NONE, 8, 8},       // 9e
+    {"SBC   A,A", 1, Operand::NONE, 4, 4},          // 9f
+    {"AND   B", 1, Operand::NONE, 4, 4},            // a0
+    {"AND   C", 1, Operand::NONE, 4, 4},            // a1
+    {"AND   D", 1, Operand::NONE, 4, 4},            // a2
+    {"AND   E", 1, Operand::NONE, 4, 4},            // a3
+    {"AND   H", 1, Operand::NONE, 4, 4},            // a4
+    {"AND   L", 1, Operand::NONE, 4, 4},            // a5
+    {"AND   (HL)", 1, Operand::NONE, 8, 8},         // a6
+    {"AND   A", 1, Operand::NONE, 4, 4},            // a7
+    {"XOR   B", 1, Operand::NONE, 4, 4},            // a8
+    {"XOR   C", 1, Operand::NONE, 4, 4},            // a9
+    {"XOR   D", 1, Operand::NONE, 4, 4},            // aa
+    {"XOR   E", 1, Operand::NONE, 4, 4},            // ab
+    {"XOR   H", 1, Operand::NONE, 4, 4},            // ac
+    {"XOR   L", 1, Operand::NONE, 4, 4},            // ad
+    {"XOR   (HL)", 1, Operand::NONE, 8, 8},         // ae
+    {"XOR   A", 1, Operand::NONE, 4, 4},            // af
+    {"OR    B", 1, Operand::NONE, 4, 4},            // b0
+    {"OR    C", 1, Operand::NONE, 4, 4},            // b1
+    {"OR    D", 1, Operand::NONE, 4, 4},            // b2
+    {"OR    E", 1, Operand::NONE, 4, 4},            // b3
+    {"OR    H", 1, Operand::NONE, 4, 4},            // b4
+    {"OR    L", 1, Operand::NONE, 4, 4},            // b5
+    {"OR    (HL)", 1, Operand::NONE, 8, 8},         // b6
+    {"OR    A", 1, Operand::NONE, 4, 4},            // b7
+    {"CP    B", 1, Operand::NONE, 4, 4},            // b8
+    {"CP    C", 1, Operand::NONE, 4, 4},            // b9
+    {"CP    D", 1, Operand::NONE, 4, 4},            // ba
+    {"CP    E", 1, Operand::NONE, 4, 4},            // bb
+    {"CP    H", 1, Operand::NONE, 4, 4},            // bc
+    {"CP    L", 1, Operand::NONE, 4, 4},            // bd
+    {"CP    (HL)", 1, Operand::NONE, 8, 8},         // be
+    {"CP    A", 1, Operand::NONE, 4, 4},            // bf
+    {"RET   NZ", 1, Operand::NONE, 8, 20},          // c0
+    {"POP   BC", 1, Operand::NONE, 12, 12},         // c1
+    {"JP    NZ,*", 3, Operand::U16, 12, 16},        // c2
+    {"JP    *", 3, Operand::U16, 16, 16},           // c3
+    {"CALL  NZ,*", 3, Operand::U16, 12, 24},        // c4
+    {"PUSH  BC", 1, Operand::NONE, 16, 16},         // c5
+    {"ADD   A,*", 2, Operand::U8, 8, 8},            // c6
+    {"RST   00H", 1, Operand::NONE, 16, 16},        // c7
+    {"RET   Z", 1, Operand::NONE, 8, 20},           // c8
+    {"RET", 1, Operand::NONE, 16, 16},              // c9
+    {"JP    Z,*", 3, Operand::U16, 12, 16},         // ca
+    {"PREFIXCB", 2, Operand::NONE, 4, 4},           // cb
+    {"CALL  Z,*", 3, Operand::U16, 12, 24},         // cc
+    {"CALL  *", 3, Operand::U16, 24, 24},           // cd
+    {"ADC   A,*", 2, Operand::U8, 8, 8},            // ce
+    {"RST   08H", 1, Operand::NONE, 16, 16},        // cf
+    {"RET   NC", 1, Operand::NONE, 8, 20},          // d0
+    {"POP   DE", 1, Operand::NONE, 12, 12},         // d1
+    {"JP    NC,*", 3, Operand::U16, 12, 16},        // d2
+    {"undefined", 1, Operand::NONE, 4, 4},          // d3
+    {"CALL  NC,*", 3, Operand::U16, 12, 24},        // d4
+    {"PUSH  DE", 1, Operand::NONE, 16, 16},         // d5
+    {"SUB   *", 2, Operand::U8, 8, 8},              // d6
+    {"RST   10H", 1, Operand::NONE, 16, 16},        // d7
+    {"RET   C", 1, Operand::NONE, 8, 20},           // d8
+    {"RETI", 1, Operand::NONE, 16, 16},             // d9
+    {"JP    C,*", 3, Operand::U16, 12, 16},         // da
+    {"undefined", 1, Operand::NONE, 4, 4},          // db
+    {"CALL  C,*", 3, Operand::U16, 12, 24},         // dc
+    {"undefined", 1, Operand::NONE, 4, 4},          // dd
+    {"SBC   A,*", 2, Operand::U8, 8, 8},            // de
+    {"RST   18H", 1, Operand::NONE, 16, 16},        // df
+    {"LDH   ($ff00+*),A", 2, Operand::U8, 12, 12},  // e0
+    {"POP   HL", 1, Operand::NONE, 12, 12},         // e1
+    {"LD    ($ff00+C),A", 1, Operand::NONE, 8, 8},  // e2
+    {"undefined", 1, Operand::NONE, 4, 4},          // e3
+    {"undefined", 1, Operand::NONE, 4, 4},          // e4
+    {"PUSH  HL", 1, Operand::NONE, 16, 16},         // e5
+    {"AND   *", 2, Operand::U8, 8, 8},              // e6
+    {"RST   20H", 1, Operand::NONE, 16, 16},        // e7
+    {"ADD   SP,*", 2, Operand::S8, 16, 16},         // e8
+    {"JP    (HL)", 1, Operand::NONE, 4, 4},         // e9
+    {"LD    (*),A", 3, Operand::U16, 16, 16},       // ea
+    {"undefined", 1, Operand::NONE, 4, 4},          // eb
+    {"undefined", 1, Operand::NONE, 4, 4},          // ec
+    {"undefined", 1, Operand::NONE, 4, 4},          // ed
+    {"XOR   *", 2, Operand::U8, 8, 8},              // ee
+    {"RST   28H", 1, Operand::NONE, 16, 16},        // ef
+    {"LDH   A,($ff00+*)", 2, Operand::U8, 12, 12},  // f0
+    {"POP   AF", 1, Operand::NONE, 12, 12},         // f1
+    {"LD    A,($ff00+C)", 1, Operand::NONE, 8, 8},  // f2
+    {"DI", 1, Operand::NONE, 4, 4},                 // f3
+    {"undefined", 1, Operand::NONE, 4, 4},          // f4
+    {"PUSH  AF", 1, Operand::NONE, 16, 16},         // f5
+    {"OR    *", 2, Operand::U8, 8, 8},              // f6
+    {"RST   30H", 1, Operand::NONE, 16, 16},        // f7
+    {"LD    HL,SP*", 2, Operand::S8, 12, 12},       // f8
+    {"LD    SP,HL", 1, Operand::NONE, 8, 8},        // f9
+    {"LD    A,(*)", 3, Operand::U16, 16, 16},       // fa
+    {"EI", 1, Operand::NONE, 4, 4},                 // fb
+    {"undefined", 1, Operand::NONE, 4, 4},          // fc
+    {"undefined", 1, Operand::NONE, 4, 4},          // fd
+    {"CP    *", 2, Operand::U8, 8, 8},              // fe
+    {"RST   38H", 1, Operand::NONE, 16, 16},        // ff
+    {"RLC   B", 2, Operand::NONE, 8, 8},            // cb 00
+    {"RLC   C", 2, Operand::NONE, 8, 8},            // cb 01
+    {"RLC   D", 2, Operand::NONE, 8, 8},            // cb 02
+    {"RLC   E", 2, Operand::NONE, 8, 8},            // cb 03
+    {"RLC   H", 2, Operand::NONE, 8, 8},            // cb 04
+    {"RLC   L", 2, Operand::NONE, 8, 8},            // cb 05
+    {"RLC   (HL)", 2, Operand::NONE, 16, 16},       // cb 06
+    {"RLC   A", 2, Operand::NONE, 8, 8},            // cb 07
+    {"RRC   B", 2, Operand::NONE, 8, 8},            // cb 08
+    {"RRC   C", 2, Operand::NONE, 8, 8},            // cb 09
+    {"RRC   D", 2, Operand::NONE, 8, 8},            // cb 0a
+    {"RRC   E", 2, Operand::NONE, 8, 8},            // cb 0b
+    {"RRC   H", 2, Operand::NONE, 8, 8},            // cb 0c
+    {"RRC   L", 2, Operand::NONE, 8, 8},            // cb 0d
+    {"RRC   (HL)", 2, Operand::NONE, 16, 16},       // cb 0e
+    {"RRC   A", 2, Operand::NONE, 8, 8},            // cb 0f
+    {"RL    B", 2, Operand::NONE, 8, 8},            // cb 10
+    {"RL    C", 2, Operand::NONE, 8, 8},            // cb 11
+    {"RL    D", 2, Operand::NONE, 8, 8},            // cb 12
+    {"RL    E", 2, Operand::NONE, 8, 8},            // cb 13
+    {"RL    H", 2, Operand::NONE, 8, 8},            // cb 14
+    {"RL    L", 2, Operand::NONE, 8, 8},            // cb 15
+    {"RL    (HL)", 2, Operand::NONE, 16, 16},       // cb 16
+    {"RL    A", 2, Operand::NONE, 8, 8},            // cb 17
+    {"RR    B", 2, Operand::NONE, 8, 8},            // cb 18
+    {"RR    C", 2, Operand::NONE, 8, 8},            // cb 19
+    {"RR    D", 2, Operand::NONE, 8, 8},            // cb 1a
+    {"RR    E", 2, Operand::NONE, 8, 8},            // cb 1b
+    {"RR    H", 2, Operand::NONE, 8, 8},            // cb 1c
+    {"RR    L", 2, Operand::NONE, 8, 8},            // cb 1d
+    {"RR    (HL)", 2, Operand::NONE, 16, 16},       // cb 1e
+    {"RR    A", 2, Operand::NONE, 8, 8},            // cb 1f
+    {"SLA   B", 2, Operand::NONE, 8, 8},            // cb 20
+    {"SLA   C", 2, Operand::NONE, 8, 8},            // cb 21
+    {"SLA   D", 2, Operand::NONE, 8, 8},            // cb 22
+    {"SLA   E", 2, Operand::NONE, 8, 8},            // cb 23
+    {"SLA   H", 2, Operand::NONE, 8, 8},            // cb 24
+    {"SLA   L", 2, Operand::NONE, 8, 8},            // cb 25
+    {"SLA   (HL)", 2, Operand::NONE, 16, 16},       // cb 26
+    {"SLA   A", 2, Operand::NONE, 8, 8},            // cb 27
+    {"SRA   B", 2, Operand::NONE, 8, 8},            // cb 28
+    {"SRA   C", 2, Operand::NONE, 8, 8},            // cb 29
+    {"SRA   D", 2, Operand::NONE, 8, 8},            // cb 2a
+    {"SRA   E", 2, Operand::NONE, 8, 8},            // cb 2b
+    {"SRA   H", 2, Operand::NONE, 8, 8},            // cb 2c
+    {"SRA   L", 2, Operand::NONE, 8, 8},            // cb 2d
+    {"SRA   (HL)", 2, Operand::NONE, 16, 16},       // cb 2e
+    {"SRA   A", 2, Operand::NONE, 8, 8},            // cb 2f
+    {"SWAP  B", 2, Operand::NONE, 8, 8},            // cb 30
+    {"SWAP  C", 2, Operand::NONE, 8, 8},            // cb 31
+    {"SWAP  D", 2, Operand::NONE, 8, 8},            // cb 32
+    {"SWAP  E", 2, Operand::NONE, 8, 8},            // cb 33
+    {"SWAP  H", 2, Operand::NONE, 8, 8},            // cb 34
+    {"SWAP  L", 2, Operand::NONE, 8, 8},            // cb 35
+    {"SWAP  (HL)", 2, Operand::NONE, 16, 16},       // cb 36
+    {"SWAP  A", 2, Operand::NONE, 8, 8},            // cb 37
+    {"SRL   B", 2, Operand::NONE, 8, 8},            // cb 38
+    {"SRL   C", 2, Operand::NONE, 8, 8},            // cb 39
+    {"SRL   D", 2, Operand::NONE, 8, 8},            // cb 3a
+    {"SRL   E", 2, Operand::NONE, 8, 8},            // cb 3b
+    {"SRL   H", 2, Operand::NONE, 8, 8},            // cb 3c
+    {"SRL   L", 2, Operand::NONE, 8, 8},            // cb 3d
+    {"SRL   (HL)", 2, Operand::NONE, 16, 16},       // cb 3e
+    {"SRL   A", 2, Operand::NONE, 8, 8},            // cb 3f
+    {"BIT   0,B", 2, Operand::NONE, 8, 8},          // cb 40
+    {"BIT   0,C", 2, Operand::NONE, 8, 8},          // cb 41
+    {"BIT   0,D", 2, Operand::NONE, 8, 8},          // cb 42
+    {"BIT   0,E", 2, Operand::NONE, 8, 8},          // cb 43
+    {"BIT   0,H", 2, Operand::NONE, 8, 8},          // cb 44
+    {"BIT   0,L", 2, Operand::NONE, 8, 8},          // cb 45
+    {"BIT   0,(HL)", 2, Operand::NONE, 12, 12},     // cb 46
+    {"BIT   0,A", 2, Operand::NONE, 8, 8},          // cb 47
+    {"BIT   1,B", 2, Operand::NONE, 8, 8},          // cb 48
+    {"BIT   1,C", 2, Operand::NONE, 8, 8},          // cb 49
+    {"BIT   1,D", 2, Operand::NONE, 8, 8},          // cb 4a
+    {"BIT   1,E", 2, Operand::NONE, 8, 8},          // cb 4b
+    {"BIT   1,H", 2, Operand::NONE, 8, 8},          // cb 4c
+    {"BIT   1,L", 2, Operand::NONE, 8, 8},          // cb 4d
+    {"BIT   1,(HL)", 2, Operand::NONE, 12, 12},     // cb 4e
+    {"BIT   1,A", 2, Operand::NONE, 8, 8},          // cb 4f
+    {"BIT   2,B", 2, Operand::NONE, 8, 8},          // cb 50
+    {"BIT   2,C", 2, Operand::NONE, 8, 8},          // cb 51
+    {"BIT   2,D", 2, Operand::NONE, 8, 8},          // cb 52
+    {"BIT   2,E", 2, Operand::NONE, 8, 8},          // cb 53
+    {"BIT   2,H", 2, Operand::NONE, 8, 8},          // cb 54
+    {"BIT   2,L", 2, Operand::NONE, 8, 8},          // cb 55
+    {"BIT   2,(HL)", 2, Operand::NONE, 12, 12},     // cb 56
+    {"BIT   2,A", 2, Operand::NONE, 8, 8},          // cb 57
+    {"BIT   3,B", 2, Operand::NONE, 8, 8},          // cb 58
+    {"BIT   3,C", 2, Operand::NONE, 8, 8},          // cb 59
+    {"BIT   3,D", 2, Operand::NONE, 8, 8},          // cb 5a
+    {"BIT   3,E", 2, Operand::NONE, 8, 8},          // cb 5b
+    {"BIT   3,H", 2, Operand::NONE, 8, 8},          // cb 5c
+    {"BIT   3,L", 2, Operand::NONE, 8, 8},          // cb 5d
+    {"BIT   3,(HL)", 2, Operand::NONE, 12, 12},     // cb 5e
+    {"BIT   3,A", 2, Operand::NONE, 8, 8},          // cb 5f
+    {"BIT   4,B", 2, Operand::NONE, 8, 8},          // cb 60
+    {"BIT   4,C", 2, Operand::NONE, 8, 8},          // cb 61
+    {"BIT   4,D", 2, Operand::NONE, 8, 8},          // cb 62
+    {"BIT   4,E", 2, Operand::NONE, 8, 8},          // cb 63
+    {"BIT   4,H", 2, Operand::NONE, 8, 8},          // cb 64
+    {"BIT   4,L", 2, Operand::NONE, 8, 8},          // cb 65
+    {"BIT   4,(HL)", 2, Operand::NONE, 12, 12},     // cb 66
+    {"BIT   4,A", 2, Operand::NONE, 8, 8},          // cb 67
+    {"BIT   5,B", 2, Operand::NONE, 8, 8},          // cb 68
+    {"BIT   5,C", 2, Operand::NONE, 8, 8},          // cb 69
+    {"BIT   5,D", 2, Operand::NONE, 8, 8},          // cb 6a
+    {"BIT   5,E", 2, Operand::NONE, 8, 8},          // cb 6b
+    {"BIT   5,H", 2, Operand::NONE, 8, 8},          // cb 6c
+    {"BIT   5,L", 2, Operand::NONE, 8, 8},          // cb 6d
+    {"BIT   5,(HL)", 2, Operand::NONE, 12, 12},     // cb 6e
+    {"BIT   5,A", 2, Operand::NONE, 8, 8},          // cb 6f
+    {"BIT   6,B", 2, Operand::NONE, 8, 8},          // cb 70
+    {"BIT   6,C", 2, Operand::NONE, 8, 8},          // cb 71
+    {"BIT   6,D", 2, Operand::NONE, 8, 8},          // cb 72
+    {"BIT   6,E", 2, Operand::NONE, 8, 8},          // cb 73
+    {"BIT   6,H", 2, Operand::NONE, 8, 8},          // cb 74
+    {"BIT   6,L", 2, Operand::NONE, 8, 8},          // cb 75
+    {"BIT   6,(HL)", 2, Operand::NONE, 12, 12},     // cb 76
+    {"BIT   6,A", 2, Operand::NONE, 8, 8},          // cb 77
+    {"BIT   7,B", 2, Operand::NONE, 8, 8},          // cb 78
+    {"BIT   7,C", 2, Operand::NONE, 8, 8},          // cb 79
+    {"BIT   7,D", 2, Operand::NONE, 8, 8},          // cb 7a
+    {"BIT   7,E", 2, Operand::NONE, 8, 8},          // cb 7b
+    {"BIT   7,H", 2, Operand::NONE, 8, 8},          // cb 7c
+    {"BIT   7,L", 2, Operand::NONE, 8, 8},          // cb 7d
+    {"BIT   7,(HL)", 2, Operand::NONE, 12, 12},     // cb 7e
+    {"BIT   7,A", 2, Operand::NONE, 8, 8},          // cb 7f
+    {"RES   0,B", 2, Operand::NONE, 8, 8},          // cb 80
+    {"RES   0,C", 2, Operand::NONE, 8, 8},          // cb 81
+    {"RES   0,D", 2, Operand::NONE, 8, 8},          // cb 82
+    {"RES   0,E", 2, Operand::NONE, 8, 8},          // cb 83
+    {"RES   0,H", 2, Operand::NONE, 8, 8},          // cb 84
+    {"RES   0,L", 2, Operand::NONE, 8, 8},          // cb 85
+    {"RES   0,(HL)", 2, Operand::NONE, 16, 16},     // cb 86
+    {"RES   0,A", 2, Operand::NONE, 8, 8},          // cb 87
+    {"RES   1,B", 2, Operand::NONE, 8, 8},          // cb 88
+    {"RES   1,C", 2, Operand::NONE, 8, 8},          // cb 89
+    {"RES   1,D", 2, Operand::NONE, 8, 8},          // cb 8a
+    {"RES   1,E", 2, Operand::NONE, 8, 8},          // cb 8b
+    {"RES   1,H", 2, Operand::NONE, 8, 8},          // cb 8c
+    {"RES   1,L", 2, Operand::NONE, 8, 8},          // cb 8d
+    {"RES   1,(HL)", 2, Operand::NONE, 16, 16},     // cb 8e
+    {"RES   1,A", 2, Operand::NONE, 8, 8},          // cb 8f
+    {"RES   2,B", 2, Operand::NONE, 8, 8},          // cb 90
+    {"RES   2,C", 2, Operand::NONE, 8, 8},          // cb 91
+    {"RES   2,D", 2, Operand::NONE, 8, 8},          // cb 92
+    {"RES   2,E", 2, Operand::NONE, 8, 8},          // cb 93
+    {"RES   2,H", 2, Operand::NONE, 8, 8},          // cb 94
+    {"RES   2,L", 2, Operand::NONE, 8, 8},          // cb 95
+    {"RES   2,(HL)", 2, Operand::NONE, 16, 16},     // cb 96
+    {"RES   2,A", 2, Operand::NONE, 8, 8},          // cb 97
+    {"RES   3,B", 2, Operand::NONE, 8, 8},          // cb 98
+    {"RES   3,C", 2, Operand::NONE, 8, 8},          // cb 99
+    {"RES   3,D", 2, Operand::NONE, 8, 8},          // cb 9a
+    {"RES   3,E", 2, Operand::NONE, 8, 8},          // cb 9b
+    {"RES   3,H", 2, Operand::NONE, 8, 8},          // cb 9c
+    {"RES   3,L", 2, Operand::NONE, 8, 8},          // cb 9d
+    {"RES   3,(HL)", 2, Operand::NONE, 16, 16},     // cb 9e
+    {"RES   3,A", 2, Operand::NONE, 8, 8},          // cb 9f
+    {"RES   4,B", 2, Operand::NONE, 8, 8},          // cb a0
+    {"RES   4,C", 2, Operand::NONE, 8, 8},          // cb a1
+    {"RES   4,D", 2, Operand::NONE, 8, 8},          // cb a2
+    {"RES   4,E", 2, Operand::NONE, 8, 8},          // cb a3
+    {"RES   4,H", 2, Operand::NONE, 8, 8},          // cb a4
+    {"RES   4,L", 2, Operand::NONE, 8, 8},          // cb a5
+    {"RES   4,(HL)", 2, Operand::NONE, 16, 16},     // cb a6
+    {"RES   4,A", 2, Operand::NONE, 8, 8},          // cb a7
+    {"RES   5,B", 2, Operand::NONE, 8, 8},          // cb a8
+    {"RES   5,C", 2, Operand::NONE, 8, 8},          // cb a9
+    {"RES   5,D", 2, Operand::NONE, 8, 8},          // cb aa
+    {"RES   5,E", 2, Operand::NONE, 8, 8},          // cb ab
+    {"RES   5,H", 2, Operand::NONE, 8, 8},          // cb ac
+    {"RES   5,L", 2, Operand::NONE, 8, 8},          // cb ad
+    {"RES   5,(HL)", 2, Operand::NONE, 16, 16},     // cb ae
+    {"RES   5,A", 2, Operand::NONE, 8, 8},          // cb af
+    {"RES   6,B", 2, Operand::NONE, 8, 8},          // cb b0
+    {"RES   6,C", 2, Operand::NONE, 8, 8},          // cb b1
+    {"RES   6,D", 2, Operand::NONE, 8, 8},          // cb b2
+    {"RES   6,E", 2, Operand::NONE, 8, 8},          // cb b3
+    {"RES   6,H", 2, Operand::NONE, 8, 8},          // cb b4
+    {"RES   6,L", 2, Operand::NONE, 8, 8},          // cb b5
+    {"RES   6,(HL)", 2, Operand::NONE, 16, 16},     // cb b6
+    {"RES   6,A", 2, Operand::NONE, 8, 8},          // cb b7
+    {"RES   7,B", 2, Operand::NONE, 8, 8},          // cb b8
+    {"RES   7,C", 2, Operand::NONE, 8, 8},          // cb b9
+    {"RES   7,D", 2, Operand::NONE, 8, 8},          // cb ba
+    {"RES   7,E", 2, Operand::NONE, 8, 8},          // cb bb
+    {"RES   7,H", 2, Operand::NONE, 8, 8},          // cb bc
+    {"RES   7,L", 2, Operand::NONE, 8, 8},          // cb bd
+    {"RES   7,(HL)", 2, Operand::NONE, 16, 16},     // cb be
+    {"RES   7,A", 2, Operand::NONE, 8, 8},          // cb bf
+    {"SET   0,B", 2, Operand::NONE, 8, 8},          // cb c0
+    {"SET   0,C", 2, Operand::NONE, 8, 8},          // cb c1
+    {"SET   0,D", 2, Operand::NONE, 8, 8},          // cb c2
+    {"SET   0,E", 2, Operand::NONE, 8, 8},          // cb c3
+    {"SET   0,H", 2, Operand::NONE, 8, 8},          // cb c4
+    {"SET   0,L", 2, Operand::NONE, 8, 8},          // cb c5
+    {"SET   0,(HL)", 2, Operand::NONE, 16, 16},     // cb c6
+    {"SET   0,A", 2, Operand::NONE, 8, 8},          // cb c7
+    {"SET   1,B", 2, Operand::NONE, 8, 8},          // cb c8
+    {"SET   1,C", 2, Operand::NONE, 8, 8},          // cb c9
+    {"SET   1,D", 2, Operand::NONE, 8, 8},          // cb ca
+    {"SET   1,E", 2, Operand::NONE, 8, 8},          // cb cb
+    {"SET   1,H", 2, Operand::NONE, 8, 8},          // cb cc
+    {"SET   1,L", 2, Operand::NONE, 8, 8},          // cb cd
+    {"SET   1,(HL)", 2, Operand::NONE, 16, 16},     // cb ce
+    {"SET   1,A", 2, Operand::NONE, 8, 8},          // cb cf
+    {"SET   2,B", 2, Operand::NONE, 8, 8},          // cb d0
+    {"SET   2,C", 2, Operand::NONE, 8, 8},          // cb d1
+    {"SET   2,D", 2, Operand::NONE, 8, 8},          // cb d2
+    {"SET   2,E", 2, Operand::NONE, 8, 8},          // cb d3
+    {"SET   2,H", 2, Operand::NONE, 8, 8},          // cb d4
+    {"SET   2,L", 2, Operand::NONE, 8, 8},          // cb d5
+    {"SET   2,(HL)", 2, Operand::NONE, 16, 16},     // cb d6
+    {"SET   2,A", 2, Operand::NONE, 8, 8},          // cb d7
+    {"SET   3,B", 2, Operand::NONE, 8, 8},          // cb d8
+    {"SET   3,C", 2, Operand::NONE, 8, 8},          // cb d9
+    {"SET   3,D", 2, Operand::NONE, 8, 8},          // cb da
+    {"SET   3,E", 2, Operand::NONE, 8, 8},          // cb db
+    {"SET   3,H", 2, Operand::NONE, 8, 8},          // cb dc
+    {"SET   3,L", 2, Operand::NONE, 8, 8},          // cb dd
+    {"SET   3,(HL)", 2, Operand::NONE, 16, 16},     // cb de
+    {"SET   3,A", 2, Operand::NONE, 8, 8},          // cb df
+    {"SET   4,B", 2, Operand::NONE, 8, 8},          // cb e0
+    {"SET   4,C", 2, Operand::NONE, 8, 8},          // cb e1
+    {"SET   4,D", 2, Operand::NONE, 8, 8},          // cb e2
+    {"SET   4,E", 2, Operand::NONE, 8, 8},          // cb e3
+    {"SET   4,H", 2, Operand::NONE, 8, 8},          // cb e4
+    {"SET   4,L", 2, Operand::NONE, 8, 8},          // cb e5
+    {"SET   4,(HL)", 2, Operand::NONE, 16, 16},     // cb e6
+    {"SET   4,A", 2, Operand::NONE, 8, 8},          // cb e7
+    {"SET   5,B", 2, Operand::NONE, 8, 8},          // cb e8
+    {"SET   5,C", 2, Operand::NONE, 8, 8},          // cb e9
+    {"SET   5,D", 2, Operand::NONE, 8, 8},          // cb ea
+    {"SET   5,E", 2, Operand::NONE, 8, 8},          // cb eb
+    {"SET   5,H", 2, Operand::NONE, 8, 8},          // cb ec
+    {"SET   5,L", 2, Operand::NONE, 8, 8},          // cb ed
+    {"SET   5,(HL)", 2, Operand::NONE, 16, 16},     // cb ee
+    {"SET   5,A", 2, Operand::NONE, 8, 8},          // cb ef
+    {"SET   6,B", 2, Operand::NONE, 8, 8},          // cb f0
+    {"SET   6,C", 2, Operand::NONE, 8, 8},          // cb f1
+    {"SET   6,D", 2, Operand::NONE, 8, 8},          // cb f2
+    {"SET   6,E", 2, Operand::NONE, 8, 8},          // cb f3
+    {"SET   6,H", 2, Operand::NONE, 8, 8},          // cb f4
+    {"SET   6,L", 2, Operand::NONE, 8, 8},          // cb f5
+    {"SET   6,(HL)", 2, Operand::NONE, 16, 16},     // cb f6
+    {"SET   6,A", 2, Operand::NONE, 8, 8},          // cb f7
+    {"SET   7,B", 2, Operand::NONE, 8, 8},          // cb f8
+    {"SET   7,C", 2, Operand::NONE, 8, 8},          // cb f9
+    {"SET   7,D", 2, Operand::NONE, 8, 8},          // cb fa
+    {"SET   7,E", 2, Operand::NONE, 8, 8},          // cb fb
+    {"SET   7,H", 2, Operand::NONE, 8, 8},          // cb fc
+    {"SET   7,L", 2, Operand::NONE, 8, 8},          // cb fd
+    {"SET   7,(HL)", 2, Operand::NONE, 16, 16},     // cb fe
+    {"SET   7,A", 2, Operand::NONE, 8, 8},          // cb ff
+};
+
+// Metadata for the instruction starting at bytes
+constexpr const Opcode& opcode(const uint8_t* bytes) {
+    return bytes[0] == 0xcb ? OPCODES[0x100 | bytes[1]] : OPCODES[bytes[0]];
+}
+
+#endif // OPCODES_HPP
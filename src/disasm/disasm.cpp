@@ -0,0 +1,54 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+#include "../cpu/disassembler.hpp"
+
+// Disassemble a whole ROM linearly, one instruction per line
+// Usage: rugbe-disasm <rom> [--output <file>]
+
+// Characters formatted per write
+const size_t CHUNK_SIZE = 1 << 16;
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: rugbe-disasm <rom> [--output <file>]" << std::endl;
+        return 1;
+    }
+
+    const char* output = nullptr;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        }
+    }
+
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open ROM." << std::endl;
+        return 1;
+    }
+    std::vector<uint8_t> rom((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+
+    std::ofstream out_file;
+    if (output) {
+        out_file.open(output, std::ios::binary | std::ios::trunc);
+        if (!out_file) {
+            std::cerr << "Failed to open output." << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = output ? out_file : std::cout;
+
+    static char buffer[CHUNK_SIZE];
+    size_t offset = 0;
+    while (offset < rom.size()) {
+        size_t written = disassemble_rom(rom.data(), rom.size(), offset,
+                                         buffer, CHUNK_SIZE);
+        out.write(buffer, written);
+    }
+
+    return out ? 0 : 1;
+}
@@ -1,20 +1,111 @@
-#include <iostream>
+#include <atomic>
 #include "gameboy.hpp"
+#include "profile/zones.hpp"
 
-GameBoy::GameBoy(const char* filepath) : mmu {&cpu, &ppu}, cpu {Cpu(&mmu, &ppu)}
-{
-    mmu.load_rom(filepath);
+GameBoy::GameBoy()
+    : mmu {&cpu, &ppu, &joypad, &serial, &timer, &apu},
+      cpu {Cpu(&mmu, &ppu)}, ppu {&cpu, &mmu}, joypad {&mmu},
+      timer {&cpu, &mmu}, apu {&cpu} {}
+
+bool GameBoy::load_rom(const char* filepath) {
+    ZONE("load rom");
+    return mmu.load_rom(filepath);
+}
+
+bool GameBoy::load_rom(const uint8_t* data, size_t size) {
+    return mmu.load_rom(data, size);
 }
 
 void GameBoy::emulate() { 
-    // Reset cycle counter
-    cpu.cycles = 0;
+    ZONE("emulate");
 
     // Emulate one frame
-    while (cpu.cycles < 70224) {
-        cpu.execute_instruction();
-        ppu.step_clock();
+    begin_frame();
+    run_until(FRAME_CYCLES);
+}
+
+void GameBoy::begin_frame() {
+    // Reset cycle counter, carrying the frame's cycles into the clock
+    cpu.clock_base += cpu.cycles;
+    cpu.cycles = 0;
+
+    joypad.begin_frame(cpu.clock());
+}
+
+void GameBoy::run_until(int target) {
+    ZONE("cpu");
+    while (cpu.cycles < target) {
+        step();
     }
+
+    // Finish the lines the frontend will present, and the samples
+    ppu.catch_up();
+    apu.end_frame();
+}
+
+void GameBoy::step() {
+    cpu.execute_instruction();
+
+    // The PPU and timer only run when touched or when they are due to
+    // request an interrupt, and queued inputs apply at their cycle
+    uint64_t now = cpu.clock();
+    if (now >= ppu.event) ppu.catch_up();
+    if (now >= timer.event) timer.overflow();
+    if (now >= joypad.event) joypad.update(now);
 }
 
-void GameBoy::test_boot_rom() { mmu.test_boot_rom(); };
\ No newline at end of file
+void GameBoy::test_boot_rom() { mmu.test_boot_rom(); };
+
+void GameBoy::skip_boot_rom() {
+    CpuState state {0x01b0, 0x0013, 0x00d8, 0x014d, 0xfffe, 0x0100, 0};
+    cpu.load_state(state);
+
+    // LCD and background on, tile data at $8000
+    ppu.lcd_switch = true;
+    ppu.bg_tile = true;
+    ppu.bg_switch = true;
+    ppu.palette = 0xfc;
+}
+
+void GameBoy::save_state(State& state) {
+    // The header goes in last, so that a save cut short by a crash, into
+    // a mapped state, never leaves a state that passes valid()
+    state.magic = 0;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+
+    cpu.save_state(state.cpu);
+    mmu.save_state(state);
+    ppu.save_state(state);
+    joypad.save_state(state.joypad);
+    timer.save_state(state.timer);
+    apu.save_state(state.apu);
+
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    state.stamp();
+}
+
+bool GameBoy::load_state(const State& state) {
+    if (!state.valid()) return false;
+
+    // Memory first, as the CPU recomputes its pending interrupts from it
+    mmu.load_state(state);
+    cpu.load_state(state.cpu);
+    ppu.load_state(state);
+    joypad.load_state(state.joypad);
+    timer.load_state(state.timer);
+    apu.load_state(state.apu);
+    return true;
+}
+
+bool GameBoy::save_state(const char* filepath) {
+    ZONE("state file");
+    State state;
+    save_state(state);
+    return write_state_file(filepath, state);
+}
+
+bool GameBoy::load_state(const char* filepath) {
+    ZONE("state file");
+    State state;
+    return read_state_file(filepath, state) && load_state(state);
+}
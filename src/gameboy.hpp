@@ -3,16 +3,58 @@
 #include "mmu/mmu.hpp"
 #include "cpu/cpu.hpp"
 #include "ppu/ppu.hpp"
+#include "joypad/joypad.hpp"
+#include "serial/serial.hpp"
+#include "timer/timer.hpp"
+#include "apu/apu.hpp"
+#include "state/state.hpp"
+
+// Cycles in one frame
+const int FRAME_CYCLES = 70224;
 
 class GameBoy {
     public :
         Mmu mmu;
         Cpu cpu;
         Ppu ppu;
+        Joypad joypad;
+        Serial serial;
+        Timer timer;
+        Apu apu;
+
+        GameBoy();
+
+        // The components point at each other, so a GameBoy can't be copied
+        GameBoy(const GameBoy&) = delete;
+        GameBoy& operator=(const GameBoy&) = delete;
+
+        // Load a ROM from a file or a buffer. Returns false on failure.
+        bool load_rom(const char*);
+        bool load_rom(const uint8_t*, size_t);
 
-        GameBoy(const char*);
         void emulate();
+
+        // Emulate a frame in pieces: begin_frame() resets the frame's
+        // cycle counter, run_until() runs until it reaches the target
+        void begin_frame();
+        void run_until(int);
+
+        // Execute one instruction and fire the events it made due
+        void step();
         void test_boot_rom();
+
+        // Start at $0100 in the state the DMG boot ROM leaves behind,
+        // as cartridges and test ROMs expect
+        void skip_boot_rom();
+
+        // Snapshot the whole machine into/out of a preallocated state.
+        // load_state returns false if the state is from another version.
+        void save_state(State&);
+        bool load_state(const State&);
+
+        // Save/load a state file
+        bool save_state(const char*);
+        bool load_state(const char*);
 };
 
-#endif // GAMEBOY_HPP
\ No newline at end of file
+#endif // GAMEBOY_HPP
@@ -0,0 +1,41 @@
+#include <SDL2/SDL.h>
+#include "input.hpp"
+#include "../joypad/joypad.hpp"
+
+struct Key {
+    int scancode;
+    uint8_t button;
+};
+
+static const Key KEYS[] = {
+    {SDL_SCANCODE_RIGHT, BUTTON_RIGHT},
+    {SDL_SCANCODE_LEFT, BUTTON_LEFT},
+    {SDL_SCANCODE_UP, BUTTON_UP},
+    {SDL_SCANCODE_DOWN, BUTTON_DOWN},
+    {SDL_SCANCODE_Z, BUTTON_A},
+    {SDL_SCANCODE_X, BUTTON_B},
+    {SDL_SCANCODE_BACKSPACE, BUTTON_SELECT},
+    {SDL_SCANCODE_RETURN, BUTTON_START}
+};
+
+void Input::pump() {
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+        if (event.type == SDL_QUIT) quit = true;
+    }
+
+    const Uint8* state = SDL_GetKeyboardState(nullptr);
+    if (state[SDL_SCANCODE_ESCAPE]) quit = true;
+    rewind = state[SDL_SCANCODE_R];
+}
+
+uint8_t Input::sample() {
+    pump();
+
+    const Uint8* state = SDL_GetKeyboardState(nullptr);
+    uint8_t buttons = 0;
+    for (const Key& key : KEYS) {
+        if (state[key.scancode]) buttons |= key.button;
+    }
+    return buttons;
+}
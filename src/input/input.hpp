@@ -0,0 +1,28 @@
+#ifndef INPUT_HPP
+#define INPUT_HPP
+#include <cstdint>
+
+// Host input
+// Reads the keyboard through SDL: the arrow keys, Z (A), X (B), Enter
+// (Start) and Backspace (Select). R is held to rewind. Escape or closing
+// the window quits.
+
+class Input {
+    public:
+        // Set once the user asks to quit
+        bool quit;
+
+        // Set while the rewind key is held, as of the last pump()
+        bool rewind;
+
+        Input() : quit {false}, rewind {false} {}
+
+        // Handle pending window events and the quit key. Call once per
+        // frame so the window stays responsive.
+        void pump();
+
+        // Pump events and return the buttons held
+        uint8_t sample();
+};
+
+#endif // INPUT_HPP
@@ -0,0 +1,65 @@
+#ifndef INPUT_QUEUE_HPP
+#define INPUT_QUEUE_HPP
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Buttons held from a CPU clock (Cpu::clock()) on
+struct InputEvent {
+    uint64_t cycle;
+    uint8_t  buttons;
+};
+
+// Timestamped input queue
+// A lock-free single-producer, single-consumer ring. One thread, such as
+// a frontend's input thread or a bot, pushes events in timestamp order;
+// the emulation thread applies each one when the clock reaches it. Each
+// instance has its own queue, so many instances can be driven without
+// any locks.
+
+class InputQueue {
+    private:
+        std::vector<InputEvent> events;
+        size_t mask;
+
+        // Advanced by the consumer and the producer respectively, on
+        // separate cache lines
+        alignas(64) std::atomic<size_t> head;
+        alignas(64) std::atomic<size_t> tail;
+
+    public:
+        // capacity is rounded up to a power of two
+        InputQueue(size_t capacity = 1024) : head {0}, tail {0} {
+            size_t size = 1;
+            while (size < capacity) size <<= 1;
+            events.resize(size);
+            mask = size - 1;
+        }
+
+        InputQueue(const InputQueue&) = delete;
+        InputQueue& operator=(const InputQueue&) = delete;
+
+        // Producer only. Returns false if the queue is full.
+        bool push(const InputEvent& event) {
+            size_t t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) > mask) return false;
+            events[t & mask] = event;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer only. The oldest event, or nullptr if there is none.
+        const InputEvent* peek() const {
+            size_t h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire)) return nullptr;
+            return &events[h & mask];
+        }
+
+        void pop() {
+            size_t h = head.load(std::memory_order_relaxed);
+            head.store(h + 1, std::memory_order_release);
+        }
+};
+
+#endif // INPUT_QUEUE_HPP
@@ -0,0 +1,47 @@
+#include "joypad.hpp"
+#include "../mmu/mmu.hpp"
+
+Joypad::Joypad(Mmu* mmu)
+    : mmu {mmu}, polled {false}, buttons {0}, select {0x30},
+      queue {nullptr}, event {UINT64_MAX} {}
+
+uint8_t Joypad::read(uint64_t now) {
+    if (poll && !polled) {
+        polled = true;
+        set(poll());
+    }
+    update(now);
+
+    uint8_t keys = 0;
+    if (!(select & 0x10)) keys |= buttons & 0x0f;
+    if (!(select & 0x20)) keys |= buttons >> 4;
+    return 0xc0 | select | (~keys & 0x0f);
+}
+
+void Joypad::set(uint8_t held) {
+    // A newly pressed key pulls its line low if its group is selected
+    uint8_t pressed = held & ~buttons;
+    buttons = held;
+
+    uint8_t lines = 0;
+    if (!(select & 0x10)) lines |= pressed & 0x0f;
+    if (!(select & 0x20)) lines |= pressed >> 4;
+    if (lines) mmu->request_interrupt(INT_JOYPAD);
+}
+
+void Joypad::begin_frame(uint64_t now) {
+    if (poll && !polled) set(poll());
+    polled = false;
+    update(now);
+}
+
+void Joypad::update(uint64_t now) {
+    if (!queue) return;
+
+    const InputEvent* next;
+    while ((next = queue->peek()) && next->cycle <= now) {
+        set(next->buttons);
+        queue->pop();
+    }
+    event = next ? next->cycle : UINT64_MAX;
+}
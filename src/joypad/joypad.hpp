@@ -0,0 +1,85 @@
+#ifndef JOYPAD_HPP
+#define JOYPAD_HPP
+#include <cstdint>
+#include <functional>
+
+#include "../state/state.hpp"
+#include "input_queue.hpp"
+class Mmu;
+
+// Button bits, set while a button is held
+enum Button: uint8_t {
+    BUTTON_RIGHT  = 0x01,
+    BUTTON_LEFT   = 0x02,
+    BUTTON_UP     = 0x04,
+    BUTTON_DOWN   = 0x08,
+    BUTTON_A      = 0x10,
+    BUTTON_B      = 0x20,
+    BUTTON_SELECT = 0x40,
+    BUTTON_START  = 0x80
+};
+
+// Joypad register ($ff00)
+// The game selects the direction keys (P14) and/or the button keys (P15)
+// by writing 0 to bit 4/5, then reads the selected keys from the low
+// nibble, where 0 means pressed. Pressing a selected key requests the
+// joypad interrupt.
+//
+// Buttons come from set(), from poll, which samples the host on the
+// first read of each frame so that the game sees input as late as
+// possible, and from a queue of timestamped inputs. A game waiting in
+// HALT or STOP for the joypad interrupt doesn't read $ff00, so after a
+// frame without a read, poll is sampled at the start of the next one.
+
+class Joypad {
+    private:
+        Mmu* mmu;
+
+        // Set once poll has been called this frame
+        bool polled;
+
+    public:
+        // Currently held buttons
+        uint8_t buttons;
+
+        // Select lines, bits 4-5 of $ff00
+        uint8_t select;
+
+        // Returns the host's held buttons when set
+        std::function<uint8_t()> poll;
+
+        // Timestamped inputs when set
+        InputQueue* queue;
+
+        // Clock of the next queued input; UINT64_MAX if none is known yet.
+        // Inputs pushed to an empty queue are seen at the next frame or
+        // read of $ff00.
+        uint64_t event;
+
+        Joypad(Mmu*);
+
+        uint8_t read(uint64_t);
+        void write(uint8_t data) { select = data & 0x30; }
+
+        // Change the held buttons
+        void set(uint8_t);
+
+        // Apply the queued inputs due by the given clock
+        void update(uint64_t);
+
+        // Called at the start of each frame
+        void begin_frame(uint64_t);
+
+        // Copy buttons and select lines to/from a save state
+        void save_state(JoypadState& state) const {
+            state.buttons = buttons;
+            state.select = select;
+        }
+
+        void load_state(const JoypadState& state) {
+            buttons = state.buttons;
+            select = state.select;
+        }
+};
+
+#endif // JOYPAD_HPP
@@ -0,0 +1,226 @@
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include "lockstep.hpp"
+
+// Execute one instruction the way GameBoy::run_until does
+static void reference_step(GameBoy& gb) {
+    gb.step();
+}
+
+const std::vector<EngineInfo>& engines() {
+    static const std::vector<EngineInfo> list = {
+        {"reference", "GameBoy::step, one instruction per step",
+         reference_step},
+        {"state-roundtrip", "the reference, saving and reloading a state "
+         "after every instruction",
+         [state = std::make_shared<State>()](GameBoy& gb) {
+             reference_step(gb);
+             gb.save_state(*state);
+             gb.load_state(*state);
+         }}
+    };
+    return list;
+}
+
+const EngineInfo* find_engine(const std::string& name) {
+    for (const EngineInfo& engine : engines()) {
+        if (name == engine.name) return &engine;
+    }
+    return nullptr;
+}
+
+Lockstep::Lockstep(Engine reference_step, Engine candidate_step, size_t context)
+    : reference_step {reference_step}, candidate_step {candidate_step},
+      reference {std::make_unique<GameBoy>()},
+      candidate {std::make_unique<GameBoy>()},
+      reference_trace {context}, candidate_trace {context},
+      diverged {false}, divergence {}
+{
+    reference->cpu.tracer = &reference_trace;
+    candidate->cpu.tracer = &candidate_trace;
+}
+
+bool Lockstep::load_rom(const char* filepath) {
+    if (!reference->load_rom(filepath) || !candidate->load_rom(filepath)) {
+        return false;
+    }
+    reference->test_boot_rom();
+    candidate->test_boot_rom();
+    return true;
+}
+
+bool Lockstep::load_rom(const uint8_t* data, size_t size) {
+    if (!reference->load_rom(data, size) || !candidate->load_rom(data, size)) {
+        return false;
+    }
+    reference->test_boot_rom();
+    candidate->test_boot_rom();
+    return true;
+}
+
+void Lockstep::advance(GameBoy& gb, const Engine& step) {
+    if (gb.cpu.cycles >= FRAME_CYCLES) gb.begin_frame();
+    step(gb);
+}
+
+bool Lockstep::run(uint64_t steps) {
+    if (diverged) return false;
+
+    for (uint64_t i = 0; i < steps; ++i) {
+        advance(*candidate, candidate_step);
+
+        // The candidate may run whole blocks per step; catch up to it
+        while (reference->cpu.instructions < candidate->cpu.instructions) {
+            advance(*reference, reference_step);
+        }
+
+        if (!compare_step()) return false;
+    }
+    return true;
+}
+
+uint64_t Lockstep::instructions() const {
+    return reference->cpu.instructions;
+}
+
+bool Lockstep::compare(const char* what, int64_t expected, int64_t actual,
+                       uint16_t address) {
+    if (expected == actual) return true;
+
+    diverged = true;
+    divergence = {reference->cpu.instructions, what, address, expected, actual};
+    return false;
+}
+
+// Compare the pages of a and b whose bits are set, page 0 being at base
+bool Lockstep::compare_pages(const char* what, const uint8_t* a,
+                             const uint8_t* b, uint64_t bits, uint16_t base) {
+    for (int page = 0; bits; ++page, bits >>= 1) {
+        if (!(bits & 1)) continue;
+
+        const uint8_t* pa = a + page * 256;
+        const uint8_t* pb = b + page * 256;
+        if (std::memcmp(pa, pb, 256) == 0) continue;
+
+        for (int k = 0; k < 256; ++k) {
+            if (!compare(what, pa[k], pb[k], base + page * 256 + k)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool Lockstep::compare_step() {
+    CpuState rc, cc;
+    reference->cpu.save_state(rc);
+    candidate->cpu.save_state(cc);
+
+    bool same = compare("PC", rc.pc, cc.pc) &&
+                compare("A", rc.af >> 8, cc.af >> 8) &&
+                compare("flags", rc.af & 0xf0, cc.af & 0xf0) &&
+                compare("BC", rc.bc, cc.bc) &&
+                compare("DE", rc.de, cc.de) &&
+                compare("HL", rc.hl, cc.hl) &&
+                compare("SP", rc.sp, cc.sp) &&
+                compare("cycles", rc.cycles, cc.cycles) &&
+                compare("IME", rc.ime, cc.ime) &&
+                compare("HALT", rc.halted, cc.halted) &&
+                compare("EI delay", rc.ei_delay, cc.ei_delay);
+    if (!same) return false;
+
+    // The PPU and timer as they stand at the CPU's clock, whether or not
+    // either machine has caught them up
+    const Ppu& rp = reference->ppu;
+    const Ppu& cp = candidate->ppu;
+    Ppu::Timing rt = rp.timing();
+    Ppu::Timing ct = cp.timing();
+    same = compare("PPU mode", rt.mode, ct.mode) &&
+           compare("PPU mode clock", rt.mode_clock, ct.mode_clock) &&
+           compare("LY", rt.scanline, ct.scanline) &&
+           compare("LCDC", (rp.lcd_switch << 7) | (rp.bg_tile << 4) |
+                           (rp.bg_map << 3) | rp.bg_switch,
+                   (cp.lcd_switch << 7) | (cp.bg_tile << 4) |
+                           (cp.bg_map << 3) | cp.bg_switch) &&
+           compare("SCY", rp.scy, cp.scy) &&
+           compare("SCX", rp.scx, cp.scx) &&
+           compare("BGP", rp.palette, cp.palette);
+    if (!same) return false;
+
+    Timer::Registers rr = reference->timer.registers();
+    Timer::Registers cr = candidate->timer.registers();
+    same = compare("DIV", rr.div, cr.div) &&
+           compare("TIMA", rr.tima, cr.tima) &&
+           compare("TAC", rr.tac, cr.tac) &&
+           compare("IF", reference->mmu.at(0xff0f),
+                   candidate->mmu.at(0xff0f)) &&
+           compare("IE", reference->mmu.at(0xffff),
+                   candidate->mmu.at(0xffff)) &&
+           compare("joypad select", reference->joypad.select,
+                   candidate->joypad.select);
+    if (!same) return false;
+
+    // Only pages written since the last step can differ
+    for (int word = 0; word < 4; ++word) {
+        uint64_t bits = reference->mmu.dirty[word] | candidate->mmu.dirty[word];
+        if (!compare_pages("memory", &reference->mmu.at(0) + word * 0x4000,
+                           &candidate->mmu.at(0) + word * 0x4000, bits,
+                           word * 0x4000)) {
+            return false;
+        }
+    }
+    if (!compare_pages("VRAM", rp.vram_data(), cp.vram_data(),
+                       rp.dirty | cp.dirty, 0x8000)) {
+        return false;
+    }
+
+    reference->mmu.dirty.fill(0);
+    candidate->mmu.dirty.fill(0);
+    reference->ppu.dirty = 0;
+    candidate->ppu.dirty = 0;
+    return true;
+}
+
+// Flags in F as ZNHC, with - for a clear flag
+static std::string flag_string(int64_t f) {
+    std::string s = "----";
+    if (f & 0x80) s[0] = 'Z';
+    if (f & 0x40) s[1] = 'N';
+    if (f & 0x20) s[2] = 'H';
+    if (f & 0x10) s[3] = 'C';
+    return s;
+}
+
+void Lockstep::report(std::ostream& out) const {
+    if (!diverged) {
+        out << "No divergence in " << reference->cpu.instructions
+            << " instructions." << std::endl;
+        return;
+    }
+
+    out << "Diverged after " << divergence.instructions << " instructions: "
+        << divergence.what;
+    if (divergence.what == "memory" || divergence.what == "VRAM") {
+        out << " at $" << std::hex << std::setw(4) << std::setfill('0')
+            << divergence.address;
+    }
+    if (divergence.what == "flags") {
+        out << ": expected " << flag_string(divergence.expected)
+            << ", got " << flag_string(divergence.actual);
+    } else {
+        out << std::hex << std::setfill('0')
+            << ": expected $" << std::setw(2) << divergence.expected
+            << ", got $" << std::setw(2) << divergence.actual;
+    }
+    out << std::dec << std::setfill(' ') << std::endl;
+
+    std::vector<TraceRecord> records;
+    out << std::endl << "Reference:" << std::endl;
+    reference_trace.snapshot(records);
+    for (const TraceRecord& record : records) print_record(out, record);
+
+    out << std::endl << "Candidate:" << std::endl;
+    candidate_trace.snapshot(records);
+    for (const TraceRecord& record : records) print_record(out, record);
+}
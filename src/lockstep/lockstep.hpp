@@ -0,0 +1,88 @@
+#ifndef LOCKSTEP_HPP
+#define LOCKSTEP_HPP
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../gameboy.hpp"
+#include "../trace/trace.hpp"
+
+// Differential execution
+// Runs a reference engine and a candidate engine on two machines loaded
+// with the same ROM, in lockstep, and compares registers, flags, cycles,
+// PPU, timer, interrupt and joypad state and every memory page written
+// after each step. Nothing is caught up for the comparison, so a
+// divergence that only shows while the PPU or timer lags behind the CPU
+// isn't hidden.
+// The first divergence is reported with the instructions that led up to
+// it on both machines. Any change to how the CPU executes (dispatch,
+// flags, block caching) should run clean against the reference first.
+
+// Runs one instruction, or a block of them, on a machine. Frame
+// boundaries are handled by the harness.
+typedef std::function<void(GameBoy&)> Engine;
+
+struct EngineInfo {
+    const char* name;
+    const char* description;
+    Engine step;
+};
+
+// The engines that can be compared, the reference first
+const std::vector<EngineInfo>& engines();
+
+// The engine called name, or nullptr
+const EngineInfo* find_engine(const std::string& name);
+
+struct Divergence {
+    // Instructions executed by the reference when it was found
+    uint64_t instructions;
+
+    // What differed, e.g. "register BC" or "memory"
+    std::string what;
+    uint16_t address;
+    int64_t expected;
+    int64_t actual;
+};
+
+class Lockstep {
+    private:
+        Engine reference_step;
+        Engine candidate_step;
+        std::unique_ptr<GameBoy> reference;
+        std::unique_ptr<GameBoy> candidate;
+
+        // The last instructions on each machine, for context
+        Tracer reference_trace;
+        Tracer candidate_trace;
+
+        bool diverged;
+        Divergence divergence;
+
+        void advance(GameBoy&, const Engine&);
+        bool compare(const char*, int64_t, int64_t, uint16_t address = 0);
+        bool compare_pages(const char*, const uint8_t*, const uint8_t*,
+                           uint64_t bits, uint16_t base);
+        bool compare_step();
+
+    public:
+        Lockstep(Engine reference, Engine candidate, size_t context = 16);
+
+        bool load_rom(const char*);
+        bool load_rom(const uint8_t*, size_t);
+
+        // Run the candidate for up to steps steps, stopping at the first
+        // divergence. Returns false if one was found.
+        bool run(uint64_t steps);
+
+        // Instructions executed by the reference so far
+        uint64_t instructions() const;
+
+        // Print the divergence and the instructions before it
+        void report(std::ostream&) const;
+};
+
+#endif // LOCKSTEP_HPP
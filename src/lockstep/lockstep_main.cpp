@@ -0,0 +1,50 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "lockstep.hpp"
+
+// Run a candidate engine against the reference on a ROM
+// Usage: rugbe-lockstep <rom> [--candidate <engine>] [--steps <count>]
+//                             [--context <instructions>]
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: rugbe-lockstep <rom> [--candidate <engine>] "
+                  << "[--steps <count>] [--context <instructions>]"
+                  << std::endl << "Engines:" << std::endl;
+        for (const EngineInfo& engine : engines()) {
+            std::cerr << "  " << engine.name << ": " << engine.description
+                      << std::endl;
+        }
+        return 1;
+    }
+
+    const char* candidate = "state-roundtrip";
+    uint64_t steps = 1000000;
+    size_t context = 16;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--candidate") == 0 && i + 1 < argc) {
+            candidate = argv[++i];
+        } else if (std::strcmp(argv[i], "--steps") == 0 && i + 1 < argc) {
+            steps = std::atoll(argv[++i]);
+        } else if (std::strcmp(argv[i], "--context") == 0 && i + 1 < argc) {
+            context = std::atol(argv[++i]);
+        }
+    }
+
+    const EngineInfo* engine = find_engine(candidate);
+    if (engine == nullptr) {
+        std::cerr << "Unknown engine: " << candidate << std::endl;
+        return 1;
+    }
+
+    Lockstep lockstep(engines().front().step, engine->step, context);
+    if (!lockstep.load_rom(argv[1])) {
+        std::cerr << "Failed to open ROM." << std::endl;
+        return 1;
+    }
+
+    bool same = lockstep.run(steps);
+    lockstep.report(std::cout);
+    return same ? 0 : 1;
+}
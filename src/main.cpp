@@ -1,26 +1,422 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
 #include <SDL2/SDL.h>
 
 #include "video/video.hpp"
+#include "input/input.hpp"
+#include "audio/audio.hpp"
 #include "gameboy.hpp"
+#include "runahead/runahead.hpp"
+#include "rewind/rewind.hpp"
+#include "movie/movie.hpp"
+#include "trace/trace.hpp"
+#include "profile/perf_counters.hpp"
+#include "profile/zones.hpp"
+#include "metrics/metrics.hpp"
+#include "ppu/render_worker.hpp"
+#include "capture/capture.hpp"
+
+// Frames between checkpoints when running with --state
+const int CHECKPOINT_INTERVAL = 60;
+
+// Frames between run-ahead overhead reports
+const int REPORT_INTERVAL = 300;
+
+// Frames between updates of the --overlay metrics
+const int OVERLAY_INTERVAL = 30;
+
+// Instructions kept by --trace unless --trace-size is given
+const size_t TRACE_SIZE = 1 << 20;
 
 int main(int argc, char** argv) {
-    // Setup video
-    setup_video();
+    if (argc < 2) {
+        std::cerr << "Usage: rugbe <rom> [--state <file>] "
+                  << "[--run-ahead <frames>] [--second-instance] "
+                  << "[--record <movie>] [--record-mode <frame|cycle>] "
+                  << "[--replay <movie>] "
+                  << "[--frames <count>] [--trace <file>] "
+                  << "[--trace-size <instructions>] [--perf] [--zones <file>] "
+                  << "[--overlay] [--render-thread] [--mute] [--audio-sync] "
+                  << "[--capture <video>] [--capture-audio <wav>] "
+                  << "[--rewind <MB>]" << std::endl;
+        return 1;
+    }
+
+    // Options. --state maps a state file for checkpointing/instant resume.
+    std::unique_ptr<MappedState> checkpoint;
+    int run_ahead = 0;
+    bool second_instance = false;
+    const char* record = nullptr;
+    Movie::Mode record_mode = Movie::PER_FRAME;
+    const char* replay_movie = nullptr;
+    int frames = -1;
+    const char* trace_file = nullptr;
+    size_t trace_size = TRACE_SIZE;
+    bool perf = false;
+    const char* zones_file = nullptr;
+    bool overlay = false;
+    bool render_thread = false;
+    bool mute = false;
+    bool audio_sync = false;
+    const char* capture_video = nullptr;
+    const char* capture_audio = nullptr;
+    int rewind_mb = 0;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--state") == 0 && i + 1 < argc) {
+            checkpoint = std::make_unique<MappedState>(argv[++i]);
+            if (!checkpoint->valid()) {
+                std::cerr << "Failed to map state file." << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--run-ahead") == 0 && i + 1 < argc) {
+            run_ahead = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--second-instance") == 0) {
+            second_instance = true;
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record = argv[++i];
+        } else if (std::strcmp(argv[i], "--record-mode") == 0 && i + 1 < argc) {
+            ++i;
+            if (std::strcmp(argv[i], "cycle") == 0) {
+                record_mode = Movie::PER_CYCLE;
+            } else if (std::strcmp(argv[i], "frame") != 0) {
+                std::cerr << "Unknown record mode." << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_movie = argv[++i];
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_file = argv[++i];
+        } else if (std::strcmp(argv[i], "--trace-size") == 0 && i + 1 < argc) {
+            trace_size = std::atol(argv[++i]);
+        } else if (std::strcmp(argv[i], "--perf") == 0) {
+            perf = true;
+        } else if (std::strcmp(argv[i], "--zones") == 0 && i + 1 < argc) {
+            zones_file = argv[++i];
+        } else if (std::strcmp(argv[i], "--overlay") == 0) {
+            overlay = true;
+        } else if (std::strcmp(argv[i], "--render-thread") == 0) {
+            render_thread = true;
+        } else if (std::strcmp(argv[i], "--mute") == 0) {
+            mute = true;
+        } else if (std::strcmp(argv[i], "--audio-sync") == 0) {
+            audio_sync = true;
+        } else if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            capture_video = argv[++i];
+        } else if (std::strcmp(argv[i], "--capture-audio") == 0 && i + 1 < argc) {
+            capture_audio = argv[++i];
+        } else if (std::strcmp(argv[i], "--rewind") == 0 && i + 1 < argc) {
+            rewind_mb = std::atoi(argv[++i]);
+        }
+    }
+
+#ifndef RUGBE_ZONES
+    if (zones_file) {
+        std::cerr << "Built without zones (make ZONES=1)." << std::endl;
+        zones_file = nullptr;
+    }
+#endif
+    name_zone_thread("main");
+
+    // --trace keeps the last instructions executed in a mapped file, which
+    // survives a crash. Decode it with rugbe-tracedump.
+    std::unique_ptr<Tracer> tracer;
+    if (trace_file) {
+        tracer = std::make_unique<Tracer>(trace_file, trace_size);
+        if (!tracer->valid()) {
+            std::cerr << "Failed to map trace file." << std::endl;
+            return 1;
+        }
+    }
+
+    // Replay a movie headlessly at full speed
+    if (replay_movie) {
+        Movie movie;
+        if (!movie.load(replay_movie)) {
+            std::cerr << "Failed to load movie." << std::endl;
+            return 1;
+        }
+
+        GameBoy gb;
+        if (!gb.load_rom(argv[1])) {
+            std::cerr << "Failed to open ROM." << std::endl;
+            return 1;
+        }
+        gb.test_boot_rom();
+        gb.cpu.tracer = tracer.get();
+
+        // --perf reads the host's hardware counters over the replay
+        PerfCounters counters;
+        if (perf && !counters.open()) {
+            std::cerr << "Hardware counters are unavailable." << std::endl;
+            perf = false;
+        }
+
+        // --capture streams the replay to disk. It runs at full speed, so
+        // expect frames to be dropped if the disk can't keep up.
+        std::unique_ptr<Capture> capture;
+        std::vector<int16_t> samples(Capture::FRAME_SAMPLES * 2);
+        std::function<void(GameBoy&)> on_frame;
+        if (capture_video || capture_audio) {
+            capture = std::make_unique<Capture>(capture_video, capture_audio,
+                                                Apu::SAMPLE_RATE);
+            if (!capture->valid()) {
+                std::cerr << "Failed to create capture files." << std::endl;
+                return 1;
+            }
+            if (capture_audio) gb.apu.set_output(true);
+            on_frame = [&](GameBoy&) {
+                size_t count = gb.apu.read_samples(samples.data(),
+                                                   Capture::FRAME_SAMPLES);
+                capture->push(gb.ppu.framebuffer, samples.data(), count);
+            };
+        }
+
+        if (perf) counters.start();
+        ReplayResult result = replay(gb, movie, on_frame);
+        if (perf) counters.stop();
+
+        std::cout << "Replayed " << result.frames << " frames in "
+                  << result.seconds << " s ("
+                  << result.frames / result.seconds << " fps)" << std::endl;
+        if (perf) {
+            counters.report(std::cout, gb.cpu.instructions, result.frames);
+        }
+        if (capture) {
+            capture->finish();
+            std::cout << "Captured " << capture->frames_written()
+                      << " frames, dropped " << capture->frames_dropped()
+                      << std::endl;
+        }
+        if (zones_file && !write_zones(zones_file)) {
+            std::cerr << "Failed to write zones." << std::endl;
+        }
+#ifdef RUGBE_PROFILE
+        gb.cpu.profiler.report(std::cout, gb.mmu);
+#endif
+        if (!result.ok) {
+            std::cout << "Frame hash mismatch at frame "
+                      << result.mismatch_frame << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // The framebuffer presented when running ahead isn't the real frame,
+    // so it can't be hashed into a movie
+    if (record && run_ahead > 0) {
+        std::cerr << "Run-ahead is disabled while recording." << std::endl;
+        run_ahead = 0;
+    }
+
+    // A movie is one unbroken run of frames
+    if (record && rewind_mb > 0) {
+        std::cerr << "Rewind is disabled while recording." << std::endl;
+        rewind_mb = 0;
+    }
+
+    // Frames drawn on the render thread are presented a frame late, so
+    // they can't be hashed into a movie either, run-ahead would only add
+    // that frame back, and rewinding would show each frame a step late
+    if (render_thread && (record || run_ahead > 0 || rewind_mb > 0)) {
+        std::cerr << "The render thread is disabled while recording, "
+                  << "running ahead or rewinding." << std::endl;
+        render_thread = false;
+    }
+
+    // Setup video. --audio-sync presents in step with the display, so
+    // that each emulated frame is shown for exactly one refresh.
+    Video video;
+    if (!video.setup(audio_sync)) return 1;
 
     // Load ROM into Game Boy
-    GameBoy gb(argv[1]);
+    std::cout << "Loading ROM: " << argv[1] << std::endl;
+    GameBoy gb;
+    if (!gb.load_rom(argv[1])) {
+        std::cerr << "Failed to open ROM." << std::endl;
+        return 1;
+    }
 
     // Initialize Game Boy to state for testing boot ROM
     gb.test_boot_rom();
+    gb.cpu.tracer = tracer.get();
+
+    std::unique_ptr<RenderWorker> worker;
+    if (render_thread) {
+        worker = std::make_unique<RenderWorker>();
+        gb.ppu.worker = worker.get();
+    }
 
+    // Resume from the checkpoint if it holds a valid state. Movies always
+    // start from power-on.
+    if (checkpoint && !record) {
+        const State* latest = checkpoint->latest();
+        if (latest && gb.load_state(*latest)) {
+            std::cout << "Resumed from checkpoint." << std::endl;
+        }
+    }
+
+    // --rewind keeps the given megabytes of history, stepped back through
+    // a frame at a time while the rewind key is held
+    std::unique_ptr<Rewind> rewind;
+    if (rewind_mb > 0) {
+        rewind = std::make_unique<Rewind>(&gb, size_t(rewind_mb) << 20, true);
+    }
+
+    // The APU only synthesizes once there is somewhere to play it
+    Audio audio;
+    bool playing = !mute && audio.setup();
+    if (playing) gb.apu.set_output(true);
+
+    // --audio-sync paces emulation by the audio device, with each frame
+    // stretched to one refresh of the display
+    if (audio_sync && !playing) {
+        std::cerr << "Audio sync needs audio output." << std::endl;
+        audio_sync = false;
+    }
+    if (audio_sync && video.refresh_rate() > 0) {
+        audio.match_display(video.refresh_rate());
+    }
+
+    // --capture streams what is presented to disk from a writer thread,
+    // dropping frames rather than slowing emulation down
+    std::unique_ptr<Capture> capture;
+    if (capture_video || capture_audio) {
+        capture = std::make_unique<Capture>(capture_video, capture_audio,
+                                            Apu::SAMPLE_RATE);
+        if (!capture->valid()) {
+            std::cerr << "Failed to create capture files." << std::endl;
+            return 1;
+        }
+        // Captured audio keeps the Game Boy's own timing, in step with
+        // the video, so the device's rate control and stretch resample it
+        // rather than adjusting the APU
+        if (capture_audio) {
+            gb.apu.set_output(true);
+            audio.set_resampling(true);
+        }
+    }
+    std::vector<int16_t> samples(Capture::FRAME_SAMPLES * 2);
+
+    // Sample the keyboard when the game first reads the joypad in each
+    // frame, or at the start of a frame after one without a read so that
+    // a game halted until the joypad interrupt still gets it. A movie recorded per frame holds the buttons from the start
+    // of each frame, so those are sampled before the frame instead; one
+    // recorded per cycle keeps the late sample, at the cycle it was read.
+    Input input;
+    Movie movie(record_mode);
+    if (!record) {
+        gb.joypad.poll = [&input] { return input.sample(); };
+    } else if (record_mode == Movie::PER_CYCLE) {
+        gb.joypad.poll = [&input, &movie, &gb] {
+            uint8_t buttons = input.sample();
+            movie.input(gb, buttons);
+            return buttons;
+        };
+    }
+
+    RunAhead runner(&gb, run_ahead, second_instance);
+    Metrics metrics;
+    std::string overlay_text;
 
     // Emulation loop
-    while (true) {
-        gb.emulate();
+    for (int frame = 1; frames < 0 || frame <= frames; ++frame) {
+        ZONE("frame");
+
+        // Waiting before the frame rather than after keeps the time from
+        // input to presentation short
+        if (audio_sync) {
+            ZONE("audio sync");
+            audio.wait();
+        }
+
+        // Rewinding stops at the oldest frame kept rather than carrying on
+        bool rewinding = rewind && input.rewind;
+        if (rewinding) {
+            ZONE("rewind");
+            rewind->step_back();
+        } else {
+            if (record) {
+                if (record_mode == Movie::PER_FRAME) {
+                    gb.joypad.set(input.sample());
+                }
+                movie.begin_frame(gb);
+            }
+            runner.emulate();
+            if (record) movie.end_frame(gb);
+            if (rewind) rewind->push();
+        }
+
+        // A rewound frame is the machine's own, not a run-ahead frame
+        const std::array<Pixel, 160 * 144>& framebuffer =
+            rewinding ? gb.ppu.framebuffer : runner.framebuffer();
+
+        size_t count = 0;
+        if (gb.apu.output_enabled()) {
+            count = gb.apu.read_samples(samples.data(), Capture::FRAME_SAMPLES);
+            if (playing) audio.queue(samples.data(), count, gb.apu);
+        }
+        if (capture) capture->push(framebuffer, samples.data(), count);
+        metrics.frame(gb);
+
+        if (overlay && frame % OVERLAY_INTERVAL == 0) {
+            MetricsSnapshot m = metrics.snapshot();
+            std::ostringstream text;
+            text << std::fixed;
+            text.precision(1);
+            text << m.frames_per_sec << " FPS  " << m.speed << "X\n"
+                 << m.instructions_per_sec / 1e6 << " MIPS\n"
+                 << "P50 " << m.frame_ms_p50 << "  P95 " << m.frame_ms_p95
+                 << "  P99 " << m.frame_ms_p99 << "\n"
+                 << "HALT " << m.halted_percent << "%  LAT "
+                 << m.present_ms << " MS";
+            overlay_text = text.str();
+        }
+
+        video.draw(framebuffer, overlay ? overlay_text.c_str() : nullptr);
+        metrics.presented();
+
+        if (run_ahead > 0 && frame % REPORT_INTERVAL == 0) {
+            std::cout << "Run-ahead: " << runner.overhead()
+                      << " us per frame" << std::endl;
+        }
+
+        if (checkpoint && frame % CHECKPOINT_INTERVAL == 0) {
+            ZONE("checkpoint");
+            State& slot = checkpoint->next();
+            gb.save_state(slot);
+            checkpoint->commit(slot);
+        }
+
+        input.pump();
+        if (input.quit) break;
+    }
+
+    if (capture) {
+        capture->finish();
+        std::cout << "Captured " << capture->frames_written()
+                  << " frames, dropped " << capture->frames_dropped()
+                  << std::endl;
+    }
+
+#ifdef RUGBE_PROFILE
+    gb.cpu.profiler.report(std::cout, gb.mmu);
+#endif
+
+    if (zones_file && !write_zones(zones_file)) {
+        std::cerr << "Failed to write zones." << std::endl;
+    }
+
+    if (record && !movie.save(record)) {
+        std::cerr << "Failed to save movie." << std::endl;
+        return 1;
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <chrono>
+#include "metrics.hpp"
+#include "../gameboy.hpp"
+
+static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Metrics::Metrics(size_t window)
+    : window {window}, samples(window + 1), frames {0},
+      present_ms(window), presents {0}, pending_ns {-1} {}
+
+void Metrics::frame(const GameBoy& gb) {
+    int64_t time = now_ns();
+    samples[frames % samples.size()] =
+        {time, gb.cpu.instructions, gb.cpu.halted_cycles};
+    ++frames;
+    pending_ns = time;
+}
+
+void Metrics::presented() {
+    if (pending_ns < 0) return;
+
+    present_ms[presents % window] = (now_ns() - pending_ns) / 1e6;
+    ++presents;
+    pending_ns = -1;
+}
+
+MetricsSnapshot Metrics::snapshot() const {
+    MetricsSnapshot snapshot {};
+
+    // Intervals between the samples in the ring
+    size_t count = std::min(frames, samples.size());
+    if (count < 2) return snapshot;
+
+    const Sample& first = samples[(frames - count) % samples.size()];
+    const Sample& last = samples[(frames - 1) % samples.size()];
+    size_t intervals = count - 1;
+    double seconds = (last.time_ns - first.time_ns) / 1e9;
+
+    if (seconds > 0) {
+        snapshot.instructions_per_sec =
+            (last.instructions - first.instructions) / seconds;
+        snapshot.frames_per_sec = intervals / seconds;
+        snapshot.speed = snapshot.frames_per_sec / REAL_TIME_FPS;
+    }
+
+    snapshot.halted_percent = 100.0 * (last.halted_cycles - first.halted_cycles)
+                              / (double(intervals) * FRAME_CYCLES);
+
+    std::vector<double> frame_ms;
+    for (size_t i = frames - count + 1; i < frames; ++i) {
+        const Sample& a = samples[(i - 1) % samples.size()];
+        const Sample& b = samples[i % samples.size()];
+        frame_ms.push_back((b.time_ns - a.time_ns) / 1e6);
+    }
+    std::sort(frame_ms.begin(), frame_ms.end());
+    auto percentile = [&](double p) {
+        return frame_ms[std::min(frame_ms.size() - 1,
+                                 size_t(p * frame_ms.size()))];
+    };
+    snapshot.frame_ms_p50 = percentile(0.50);
+    snapshot.frame_ms_p95 = percentile(0.95);
+    snapshot.frame_ms_p99 = percentile(0.99);
+
+    size_t latencies = std::min(presents, window);
+    if (latencies) {
+        double total = 0;
+        for (size_t i = 0; i < latencies; ++i) total += present_ms[i];
+        snapshot.present_ms = total / latencies;
+    }
+
+    return snapshot;
+}
@@ -0,0 +1,68 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+class GameBoy;
+
+// Runtime metrics
+// Rolling counters over the last frames: emulation speed, host frame time
+// percentiles, time spent halted and present latency. Cheap enough to
+// update every frame; a snapshot is computed on demand.
+
+// Frames per second of the real hardware
+const double REAL_TIME_FPS = 4194304.0 / 70224.0;
+
+struct MetricsSnapshot {
+    double instructions_per_sec;
+    double frames_per_sec;
+
+    // frames_per_sec relative to the real hardware; below 1 is slower
+    // than real time
+    double speed;
+
+    // Host time between frames
+    double frame_ms_p50;
+    double frame_ms_p95;
+    double frame_ms_p99;
+
+    // Emulated cycles the CPU spent halted
+    double halted_percent;
+
+    // Average time from the end of a frame until it was presented, or 0
+    // if nothing reports presenting
+    double present_ms;
+};
+
+class Metrics {
+    private:
+        struct Sample {
+            int64_t time_ns;
+            uint64_t instructions;
+            uint64_t halted_cycles;
+        };
+
+        // Rings of the last window + 1 frames and the last window present
+        // latencies
+        size_t window;
+        std::vector<Sample> samples;
+        size_t frames;
+        std::vector<double> present_ms;
+        size_t presents;
+
+        // End of the frame not yet presented, or -1
+        int64_t pending_ns;
+
+    public:
+        Metrics(size_t window = 120);
+
+        // Call after each frame is emulated
+        void frame(const GameBoy&);
+
+        // Call once the last frame is on screen
+        void presented();
+
+        MetricsSnapshot snapshot() const;
+};
+
+#endif // METRICS_HPP
@@ -1,13 +1,25 @@
-#include <iostream>
 #include <fstream>
 #include <memory>
 #include <cstring>
+#include <algorithm>
 #include "mmu.hpp"
 
 #include "../cpu/cpu.hpp"
 #include "../ppu/ppu.hpp"
-
-Mmu::Mmu(Cpu* cpu, Ppu* ppu) : cpu {cpu}, ppu {ppu} { mmu.fill(0); }
+#include "../joypad/joypad.hpp"
+#include "../serial/serial.hpp"
+#include "../timer/timer.hpp"
+#include "../apu/apu.hpp"
+#include "../state/state.hpp"
+
+Mmu::Mmu(Cpu* cpu, Ppu* ppu, Joypad* joypad, Serial* serial, Timer* timer,
+         Apu* apu)
+    : cpu {cpu}, ppu {ppu}, joypad {joypad}, serial {serial}, timer {timer},
+      apu {apu}
+{
+    mmu.fill(0);
+    dirty.fill(0);
+}
 
 // Read a byte from memory
 uint8_t Mmu::read(uint16_t addr) {
@@ -18,13 +30,39 @@ uint8_t Mmu::read(uint16_t addr) {
             return ppu->read_vram(addr);
 
         case 0xf000:
+            // Sound registers and wave RAM
+            if (addr >= 0xff10 && addr < 0xff40) return apu->read(addr);
+
             switch (addr) {
+                case 0xff00:
+                    return joypad->read(cpu->clock());
+
+                // Unused bits of the serial control read as 1
+                case 0xff02:
+                    return mmu.at(addr) | 0x7e;
+
+                // Timer
+                case 0xff04: case 0xff05: case 0xff06: case 0xff07:
+                    return timer->read(addr);
+
+                // Unused bits of the interrupt flags read as 1
+                case 0xff0f:
+                    return mmu.at(addr) | 0xe0;
+
                 case 0xff40:
                     return (ppu->bg_switch  ? 0x01 : 0x00) |
                         (ppu->bg_map     ? 0x08 : 0x00) |
                         (ppu->bg_tile    ? 0x10 : 0x00) |
                         (ppu->lcd_switch ? 0x80 : 0x00);
 
+                // LCD status. The mode and the LY=LYC flag depend on how
+                // far the PPU has run.
+                case 0xff41:
+                    ppu->catch_up();
+                    return 0x80 | (mmu.at(addr) & 0x78) |
+                        (ppu->scanline == mmu.at(0xff45) ? 0x04 : 0x00) |
+                        ppu->current_mode();
+
                 case 0xff42:
                     return ppu->scy;
 
@@ -32,6 +70,7 @@ uint8_t Mmu::read(uint16_t addr) {
                     return ppu->scx;
 
                 case 0xff44:
+                    ppu->catch_up();
                     return ppu->scanline;
             }
 
@@ -49,75 +88,131 @@ void Mmu::write(uint16_t addr, uint8_t data) {
     switch (addr & 0xf000) {
         // If value is written to VRAM, update the PPU's internal data
         case 0x8000: case 0x9000:
+            ppu->catch_up();
             ppu->write_vram(addr, data);
             break;
 
+        // External RAM, work RAM and its echo
+        case 0xa000: case 0xb000: case 0xc000: case 0xd000: case 0xe000:
+            mmu.at(addr) = data;
+            dirty[addr >> 14] |= uint64_t(1) << ((addr >> 8) & 63);
+            break;
+
         case 0xf000:
+            // OAM and the LCD registers change what the PPU draws from
+            // here on, so the lines before have to be drawn first
+            if (addr < 0xfea0 ? addr >= 0xfe00 : (addr & 0xfff0) == 0xff40) {
+                ppu->catch_up();
+            }
+
+            // Sound registers and wave RAM, kept by the APU
+            if (addr >= 0xff10 && addr < 0xff40) {
+                apu->write(addr, data);
+                break;
+            }
+
             switch (addr) {
-                // LCD control register
-                case 0xff40:
-                    ppu->bg_switch  = (addr & 0x1)  ? 1 : 0;
-                    ppu->bg_map     = (addr & 0x8)  ? 1 : 0;
-                    ppu->bg_tile    = (addr & 0x10) ? 1 : 0;
-                    ppu->lcd_switch = (addr & 0x80) ? 1 : 0;
+                // Joypad select lines
+                case 0xff00:
+                    joypad->write(data);
                     break;
-                
-                // Scroll Y
-                case 0xff42:
-                    ppu->scy = data;
+
+                // Serial control. A transfer on the internal clock
+                // completes at once, receiving $ff, and requests the
+                // serial interrupt.
+                case 0xff02:
+                    mmu.at(addr) = data & 0x81;
+                    if ((data & 0x81) == 0x81) {
+                        serial->send(mmu.at(0xff01));
+                        mmu.at(0xff01) = 0xff;
+                        mmu.at(0xff02) &= 0x7f;
+                        request_interrupt(INT_SERIAL);
+                    }
+                    dirty[addr >> 14] |= uint64_t(1) << ((addr >> 8) & 63);
                     break;
 
-                // Scroll X
-                case 0xff43:
-                    ppu->scx = data;
+                // Timer. DIV and TIMA are derived from the CPU's clock,
+                // so the timer keeps them rather than memory.
+                case 0xff04: case 0xff05: case 0xff06: case 0xff07:
+                    timer->write(addr, data);
                     break;
 
-                // Current scanline
-                case 0xff47:
-                    ppu->palette = data;
+                // Interrupt flags and enable. Either can make an interrupt
+                // pending, so the CPU recomputes it.
+                case 0xff0f:
+                    mmu.at(addr) = data & 0x1f;
+                    dirty[addr >> 14] |= uint64_t(1) << ((addr >> 8) & 63);
+                    cpu->update_interrupts();
+                    break;
+
+                case 0xffff:
+                    mmu.at(addr) = data;
+                    dirty[addr >> 14] |= uint64_t(1) << ((addr >> 8) & 63);
+                    cpu->update_interrupts();
+                    break;
+
+                // LCD control, scroll and palette. The PPU logs changes
+                // made during active display.
+                case 0xff40: case 0xff42: case 0xff43: case 0xff47:
+                    ppu->write_register(addr, data);
                     break;
 
                 default:
                     mmu.at(addr) = data;
+                    dirty[addr >> 14] |= uint64_t(1) << ((addr >> 8) & 63);
                     break;
             }
             break;
     }
 }
 
+void Mmu::request_interrupt(uint8_t interrupts) {
+    mmu.at(0xff0f) |= interrupts;
+    dirty[0xff0f >> 14] |= uint64_t(1) << ((0xff0f >> 8) & 63);
+    cpu->update_interrupts();
+}
+
+void Mmu::clear_interrupt(uint8_t interrupts) {
+    mmu.at(0xff0f) &= ~interrupts;
+    dirty[0xff0f >> 14] |= uint64_t(1) << ((0xff0f >> 8) & 63);
+}
+
 // Load ROM into memory
 // Currently, it loads memory into $0000 where the boot ROM begins;
 // however, a game should be loaded into memory beginning at $0100.
-void Mmu::load_rom(const char* filepath) {
-    std::cout << "Loading ROM: " << filepath << std::endl;
+// Returns false if the ROM can't be read.
+bool Mmu::load_rom(const char* filepath) {
     std::ifstream rom(filepath, std::ios::binary);
 
     // Verify that ROM opens properly
-    if (!rom) {
-        std::cerr << "Failed to open ROM." << std::endl;
-        std::exit(1);
-    }
+    if (!rom) return false;
 
-    // Find size of ROM
+    // Find size of ROM. A path that opens but can't be sized, such as a
+    // directory, gives -1.
     rom.seekg(0, std::ios::end);
-    int rom_size = rom.tellg();
+    std::streamoff end = rom.tellg();
+    if (end <= 0) return false;
     rom.clear();
     rom.seekg(0, std::ios::beg);
 
-    // Allocate memory for ROM
-    auto rom_buffer = std::make_unique<char[]>(rom_size);
+    // Allocate memory for ROM; only the first 32 KB is mapped
+    size_t rom_size = std::min(static_cast<size_t>(end), size_t(0x8000));
+    auto rom_buffer = std::make_unique<uint8_t[]>(rom_size);
 
     // Copy ROM into buffer
-    rom.read(rom_buffer.get(), rom_size);
+    rom.read(reinterpret_cast<char*>(rom_buffer.get()), rom_size);
+    if (!rom) return false;
+
+    return load_rom(rom_buffer.get(), rom_size);
+}
 
+// Load ROM from a buffer
+bool Mmu::load_rom(const uint8_t* data, size_t size) {
     // TODO: Make sure that ROM is valid
-    // Load ROM into memory
-    for (int i = 0; i < rom_size; ++i) {
-        mmu.at(i) = rom_buffer[i];
-    }
-            
-    // Clean up
-    rom.close();
+    // Without a memory bank controller, only the first 32 KB is mapped
+    size = std::min(size, size_t(0x8000));
+    std::memcpy(mmu.data(), data, size);
+    return true;
 }
 
 // Loads appopriate values into memory so that the boot ROM may be tested.
@@ -133,4 +228,15 @@ void Mmu::test_boot_rom() {
     for (int i = 0; i < 48; ++i) {
         mmu.at(i + 0x104) = nintendo_logo_hexdump.at(i); 
     }
+}
+
+// The ROM isn't part of a state, so a state can only be loaded over the
+// ROM it was saved with
+void Mmu::save_state(State& state) const {
+    std::copy(mmu.begin() + STATE_MEMORY_BASE, mmu.end(), state.memory.begin());
+}
+
+void Mmu::load_state(const State& state) {
+    std::copy(state.memory.begin(), state.memory.end(),
+              mmu.begin() + STATE_MEMORY_BASE);
 }
\ No newline at end of file
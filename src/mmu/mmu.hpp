@@ -2,8 +2,24 @@
 #define MMU_HPP
 #include <array>
 #include <cstdint>
+#include <cstddef>
 class Cpu;
 class Ppu;
+class Joypad;
+class Serial;
+class Timer;
+class Apu;
+struct State;
+
+// Interrupt sources, as laid out in IE ($ffff) and IF ($ff0f).
+// The lowest bit has the highest priority.
+enum Interrupt: uint8_t {
+    INT_VBLANK = 0x01,
+    INT_STAT   = 0x02,
+    INT_TIMER  = 0x04,
+    INT_SERIAL = 0x08,
+    INT_JOYPAD = 0x10
+};
 
 // Wrapper class for an array serving as the system's MMU.
 
@@ -12,10 +28,14 @@ class Mmu {
         std::array<uint8_t, 65536> mmu;
         Cpu* cpu;
         Ppu* ppu;
+        Joypad* joypad;
+        Serial* serial;
+        Timer* timer;
+        Apu* apu;
 
     public: 
         Mmu() {}
-        Mmu(Cpu*, Ppu*);
+        Mmu(Cpu*, Ppu*, Joypad*, Serial*, Timer*, Apu*);
 
         // Bypass CPU read/write cycles and access value in memory array
         uint8_t& at(int i) {
@@ -24,9 +44,23 @@ class Mmu {
 
         uint8_t read(uint16_t);
         void write(uint16_t, uint8_t);
+
+        // Set/clear interrupts in IF without taking CPU cycles
+        void request_interrupt(uint8_t);
+        void clear_interrupt(uint8_t);
+
+        // Dirty page tracking
+        // Each bit marks a 256-byte page written through write() since
+        // the bits were last cleared. Page n is bit (n & 63) of dirty[n >> 6].
+        std::array<uint64_t, 4> dirty;
         
-        void load_rom(const char*);
+        bool load_rom(const char*);
+        bool load_rom(const uint8_t*, size_t);
         void test_boot_rom();
+
+        // Copy memory to/from a save state
+        void save_state(State&) const;
+        void load_state(const State&);
 };
 
 #endif // MMU_HPP
\ No newline at end of file
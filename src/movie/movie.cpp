@@ -0,0 +1,178 @@
+#include <chrono>
+#include <fstream>
+#include "movie.hpp"
+#include "../gameboy.hpp"
+#include "../screen/screen.hpp"
+#include "../profile/zones.hpp"
+
+// File layout: header, then the inputs or events, then the hashes
+struct MovieHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t  mode;
+    uint8_t  reserved;
+    uint16_t hash_interval;
+    uint16_t reserved2;
+    uint32_t frames;
+    uint32_t events;
+    uint32_t hashes;
+};
+
+Movie::Movie(Mode mode, uint16_t hash_interval)
+    : last_buttons {0}, mode {mode}, hash_interval {hash_interval}, frames {0} {}
+
+bool Movie::save(const char* filepath) const {
+    ZONE("movie file");
+    std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+
+    MovieHeader header {MOVIE_MAGIC, MOVIE_VERSION, mode, 0, hash_interval, 0,
+                        frames, static_cast<uint32_t>(events.size()),
+                        static_cast<uint32_t>(hashes.size())};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if (mode == PER_FRAME) {
+        file.write(reinterpret_cast<const char*>(inputs.data()), inputs.size());
+    } else {
+        for (const MovieEvent& event : events) {
+            file.write(reinterpret_cast<const char*>(&event.frame), 4);
+            file.write(reinterpret_cast<const char*>(&event.cycle), 4);
+            file.write(reinterpret_cast<const char*>(&event.buttons), 1);
+        }
+    }
+
+    file.write(reinterpret_cast<const char*>(hashes.data()),
+               hashes.size() * sizeof(Hash128));
+    return static_cast<bool>(file);
+}
+
+bool Movie::load(const char* filepath) {
+    ZONE("movie file");
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file) return false;
+
+    file.seekg(0, std::ios::end);
+    uint64_t file_size = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    MovieHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != MOVIE_MAGIC ||
+        header.version != MOVIE_VERSION || header.mode > PER_CYCLE) {
+        return false;
+    }
+
+    // Check the counts against the file before allocating for them, so
+    // a truncated or corrupt movie fails rather than asking for gigabytes
+    uint64_t body = header.mode == PER_FRAME ? uint64_t(header.frames)
+                                             : uint64_t(header.events) * 9;
+    body += uint64_t(header.hashes) * sizeof(Hash128);
+    if (file_size < sizeof(header) + body) return false;
+
+    mode = static_cast<Mode>(header.mode);
+    hash_interval = header.hash_interval;
+    frames = header.frames;
+
+    inputs.clear();
+    events.clear();
+    if (mode == PER_FRAME) {
+        inputs.resize(frames);
+        file.read(reinterpret_cast<char*>(inputs.data()), frames);
+    } else {
+        events.resize(header.events);
+        for (MovieEvent& event : events) {
+            file.read(reinterpret_cast<char*>(&event.frame), 4);
+            file.read(reinterpret_cast<char*>(&event.cycle), 4);
+            file.read(reinterpret_cast<char*>(&event.buttons), 1);
+        }
+    }
+
+    hashes.resize(header.hashes);
+    file.read(reinterpret_cast<char*>(hashes.data()),
+              hashes.size() * sizeof(Hash128));
+    return static_cast<bool>(file);
+}
+
+void Movie::record(uint32_t cycle, uint8_t buttons) {
+    if (buttons == last_buttons) return;
+
+    events.push_back({frames, cycle, buttons});
+    last_buttons = buttons;
+}
+
+void Movie::begin_frame(const GameBoy& gb) {
+    if (mode == PER_FRAME) {
+        inputs.push_back(gb.joypad.buttons);
+    } else {
+        // The frame's cycle counter is only reset once it starts
+        record(0, gb.joypad.buttons);
+    }
+}
+
+void Movie::input(const GameBoy& gb, uint8_t buttons) {
+    if (mode == PER_CYCLE) {
+        record(gb.cpu.cycles, buttons);
+    }
+}
+
+void Movie::end_frame(const GameBoy& gb) {
+    ++frames;
+    if (hash_interval && frames % hash_interval == 0) {
+        hashes.push_back(hash_frame(gb.ppu.framebuffer));
+    }
+}
+
+ReplayResult replay(GameBoy& gb, const Movie& movie,
+                    const std::function<void(GameBoy&)>& on_frame) {
+    ReplayResult result {true, 0, 0, 0.0};
+    auto start = std::chrono::steady_clock::now();
+
+    size_t next_event = 0;
+    gb.joypad.set(0);
+
+    // Changes of input are queued at the clock they were recorded at, so
+    // a change made by a read of $ff00 is seen by that same read
+    InputQueue queue;
+    InputQueue* previous_queue = gb.joypad.queue;
+    gb.joypad.queue = &queue;
+
+    for (uint32_t frame = 0; frame < movie.frames; ++frame) {
+        if (movie.mode == Movie::PER_CYCLE) {
+            // Queued before the frame begins, which applies those at its
+            // first cycle
+            uint64_t start = gb.cpu.clock();
+            while (next_event < movie.events.size() &&
+                   movie.events[next_event].frame <= frame) {
+                const MovieEvent& event = movie.events[next_event];
+                if (!queue.push({start + event.cycle, event.buttons})) break;
+                ++next_event;
+            }
+        }
+
+        gb.begin_frame();
+        if (movie.mode == Movie::PER_FRAME) {
+            gb.joypad.set(movie.inputs.at(frame));
+        }
+
+        gb.run_until(FRAME_CYCLES);
+        ++result.frames;
+        if (on_frame) on_frame(gb);
+
+        uint32_t done = frame + 1;
+        if (movie.hash_interval && done % movie.hash_interval == 0) {
+            size_t index = done / movie.hash_interval - 1;
+            if (index < movie.hashes.size() &&
+                movie.hashes[index] != hash_frame(gb.ppu.framebuffer)) {
+                result.ok = false;
+                result.mismatch_frame = frame;
+                break;
+            }
+        }
+    }
+
+    gb.joypad.queue = previous_queue;
+
+    auto end = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    return result;
+}
@@ -0,0 +1,78 @@
+#ifndef MOVIE_HPP
+#define MOVIE_HPP
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "../util/hash.hpp"
+class GameBoy;
+
+// Input movies
+// A movie records the joypad input of a run, either as the buttons held
+// at the start of every frame or as timestamped changes, together with a
+// hash of the framebuffer every hash_interval frames. Replaying it on a
+// freshly loaded ROM reproduces the run exactly, which makes it both a
+// regression check and a benchmark made of real gameplay.
+
+const uint32_t MOVIE_MAGIC   = 0x4d424752; // "RGBM"
+const uint16_t MOVIE_VERSION = 2;
+
+// A change of input at a cycle within a frame
+struct MovieEvent {
+    uint32_t frame;
+    uint32_t cycle;
+    uint8_t  buttons;
+};
+
+struct ReplayResult {
+    bool     ok;
+
+    // Frames replayed, and the frame whose hash didn't match if !ok
+    uint32_t frames;
+    uint32_t mismatch_frame;
+
+    double   seconds;
+};
+
+class Movie {
+    private:
+        // Buttons as of the last recorded event
+        uint8_t last_buttons;
+
+        void record(uint32_t, uint8_t);
+
+    public:
+        enum Mode: uint8_t {PER_FRAME, PER_CYCLE} mode;
+        uint16_t hash_interval;
+        uint32_t frames;
+
+        // PER_FRAME: buttons held during each frame
+        std::vector<uint8_t> inputs;
+
+        // PER_CYCLE: changes of input, in order
+        std::vector<MovieEvent> events;
+
+        // Framebuffer hash after every hash_interval frames
+        std::vector<Hash128> hashes;
+
+        Movie(Mode = PER_FRAME, uint16_t hash_interval = 60);
+
+        bool save(const char*) const;
+        bool load(const char*);
+
+        // Recording
+        // Call begin_frame() before emulating each frame and end_frame()
+        // after it. In PER_CYCLE mode, call input() with the buttons about
+        // to be set whenever they change mid-frame, such as from
+        // Joypad::poll.
+        void begin_frame(const GameBoy&);
+        void input(const GameBoy&, uint8_t);
+        void end_frame(const GameBoy&);
+};
+
+// Replay a movie as fast as possible, stopping at the first frame whose
+// hash doesn't match. on_frame, if given, is called after every frame.
+ReplayResult replay(GameBoy&, const Movie&,
+                    const std::function<void(GameBoy&)>& on_frame = nullptr);
+
+#endif // MOVIE_HPP
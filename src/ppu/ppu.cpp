@@ -1,33 +1,45 @@
 #include <iostream>
-#include <SDL2/SDL.h>
 
 #include "ppu.hpp"
 #include "../mmu/mmu.hpp"
 #include "../cpu/cpu.hpp"
-#include "../video/video.hpp"
-
-Ppu::Ppu() : mode {SCANLINE_OAM},
-             mode_clock {0},
-             bg_switch {false},
-             bg_map {false},
-             bg_tile {false},
-             lcd_switch {false},
-             scy {0},
-             scx {0},
-             scanline {0},
-             palette {0}
+#include "../state/state.hpp"
+#include "../profile/zones.hpp"
+#include "render_worker.hpp"
+
+Ppu::Ppu(Cpu* cpu, Mmu* mmu) : cpu {cpu},
+                               mmu {mmu},
+                               mode {SCANLINE_OAM},
+                               mode_clock {0},
+                               synced {0},
+                               bg_switch {false},
+                               bg_map {false},
+                               bg_tile {false},
+                               lcd_switch {false},
+                               scy {0},
+                               scx {0},
+                               scanline {0},
+                               palette {0},
+                               event {0},
+                               dirty {0},
+                               worker {nullptr}
 {
-    // Initialize tileset to all white pixels
-    for (int i = 0; i < 384; ++i) {
-        for (int y = 0; y < 8; ++y) {
-            for (int x = 0; x < 8; ++x) {
-                tileset.at(i).at(y).at(x) = WHITE;
-            }
-        }
+    in_flight = false;
+    changes.reserve(256);
+    vram_changes.reserve(1024);
+    begin_frame();
+
+    // Clear VRAM and decode the tileset from it, so that the tileset
+    // always matches VRAM (load_state relies on this)
+    vram.fill(0);
+    for (uint16_t addr = 0; addr < 0x1800; addr += 2) {
+        update_tile(addr);
     }
 
     // Initialize framebuffer to all white pixels
     framebuffer.fill(WHITE);
+
+    schedule();
 }
 
 uint8_t Ppu::read_vram(uint16_t addr) {
@@ -39,17 +51,32 @@ void Ppu::write_vram(uint16_t addr, uint8_t data) {
     // VRAM is only 8192 bytes, so and addr with $1fff
     addr &= 0x1fff;
 
+    // Lines already shown keep the old contents. The worker draws them
+    // from a copy of VRAM taken before the first such write instead.
+    int line = next_line();
+    if (!worker) {
+        if (mode != VBLANK) render_lines(line);
+    } else if (line > 0 && line < 144) {
+        if (vram_changes.empty()) frame_vram = vram;
+        vram_changes.push_back({static_cast<uint8_t>(line), addr, data});
+    }
+
     vram.at(addr) = data;
+    dirty |= uint32_t(1) << (addr >> 8);
 
     // If value is not in the tileset, exit function
     if (addr > 0x17ff) return;
 
+    update_tile(addr);
+}
+
+void Ppu::decode_tile(Tileset& tileset, const uint8_t* vram, uint16_t addr) {
     // Get the address of the first byte of tile row
     addr &= 0xfffe;
 
     // Get the two bytes in the tile row
-    uint8_t byte1 = vram.at(addr);
-    uint8_t byte2 = vram.at(addr + 1);
+    uint8_t byte1 = vram[addr];
+    uint8_t byte2 = vram[addr + 1];
 
     int tile_index =  addr / 16;
     int row_index  = (addr % 16) / 2;
@@ -61,74 +88,248 @@ void Ppu::write_vram(uint16_t addr, uint8_t data) {
         bool bit1 = (byte2 >> i) & 1;
 
         // Determine pixel value
-        Pixel pixel;
-        if (!bit0 && !bit1) pixel = BLACK;
+        Pixel pixel = BLACK;
         if (bit0 && !bit1)  pixel = DARK_GRAY;
         if (!bit0 && bit1)  pixel = LIGHT_GRAY;
         if (bit0 && bit1)   pixel = WHITE;
 
-        tileset.at(tile_index).at(row_index).at(i) = pixel;
-        //std::cout << "Pixel #" << i << ": " << std::hex << tileset.at(tile_index).at(row_index).at(i) << std::endl;
+        tileset[tile_index][row_index][i] = pixel;
     }
     //std::cout << "--------------" << std::endl;
     //SDL_Delay(750);
 }
 
+void Ppu::save_state(State& state) {
+    // Draw what has been shown so far, as the log isn't saved
+    catch_up();
+    if (mode != VBLANK) {
+        if (worker) hand_over(next_line());
+        else render_lines(next_line());
+    }
+
+    state.vram = vram;
+    state.ppu.mode_clock = mode_clock;
+    state.ppu.mode = mode;
+    state.ppu.bg_switch = bg_switch;
+    state.ppu.bg_map = bg_map;
+    state.ppu.bg_tile = bg_tile;
+    state.ppu.lcd_switch = lcd_switch;
+    state.ppu.scy = scy;
+    state.ppu.scx = scx;
+    state.ppu.scanline = scanline;
+    state.ppu.palette = palette;
+}
+
+void Ppu::load_state(const State& state) {
+    // The tileset is derived from VRAM, so rather than storing it in the
+    // state, re-decode only the tile rows that differ from the current VRAM
+    for (uint16_t addr = 0; addr < 0x1800; addr += 2) {
+        if (vram[addr] != state.vram[addr] ||
+            vram[addr + 1] != state.vram[addr + 1]) {
+            vram[addr] = state.vram[addr];
+            vram[addr + 1] = state.vram[addr + 1];
+            update_tile(addr);
+        }
+    }
+
+    vram = state.vram;
+    mode_clock = state.ppu.mode_clock;
+    mode = static_cast<Mode>(state.ppu.mode);
+    bg_switch = state.ppu.bg_switch;
+    bg_map = state.ppu.bg_map;
+    bg_tile = state.ppu.bg_tile;
+    lcd_switch = state.ppu.lcd_switch;
+    scy = state.ppu.scy;
+    scx = state.ppu.scx;
+    scanline = state.ppu.scanline;
+    palette = state.ppu.palette;
+
+    // The state was caught up and drawn up to this line when saved
+    synced = cpu->clock();
+    schedule();
+
+    // The lines before were drawn when the state was saved
+    begin_frame();
+    drawn = next_line();
+}
+
+Ppu::RenderRegisters Ppu::registers() const {
+    return {bg_map, bg_tile, scy, scx, palette};
+}
+
+void Ppu::apply(RenderRegisters& registers, uint8_t reg, uint8_t value) {
+    switch (reg) {
+        case 0x40:
+            registers.bg_map  = value & 0x08;
+            registers.bg_tile = value & 0x10;
+            break;
+        case 0x42: registers.scy = value; break;
+        case 0x43: registers.scx = value; break;
+        case 0x47: registers.palette = value; break;
+    }
+}
+
+void Ppu::write_register(uint16_t addr, uint8_t data) {
+    switch (addr) {
+        // LCD control register
+        case 0xff40:
+            bg_switch  = (data & 0x1)  ? 1 : 0;
+            bg_map     = (data & 0x8)  ? 1 : 0;
+            bg_tile    = (data & 0x10) ? 1 : 0;
+            lcd_switch = (data & 0x80) ? 1 : 0;
+            break;
+
+        // Scroll Y
+        case 0xff42:
+            scy = data;
+            break;
+
+        // Scroll X
+        case 0xff43:
+            scx = data;
+            break;
+
+        // Background palette
+        case 0xff47:
+            palette = data;
+            break;
+    }
+
+    // Writes during VBlank are picked up by the next frame's start
+    int line = next_line();
+    if (line < 144) {
+        changes.push_back({static_cast<uint8_t>(line),
+                           static_cast<uint8_t>(addr), data});
+    }
+}
+
+int Ppu::next_line() const {
+    if (mode == VBLANK) return 144;
+    return mode == HBLANK ? scanline + 1 : scanline;
+}
+
+void Ppu::begin_frame() {
+    frame_registers = registers();
+    line_registers = frame_registers;
+    changes.clear();
+    vram_changes.clear();
+    applied = 0;
+    drawn = 0;
+}
+
+void Ppu::finish_frame() {
+    if (!worker) {
+        render_lines(144);
+        return;
+    }
+
+    ZONE("render handoff");
+    if (in_flight) worker->collect(framebuffer);
+    worker->submit(vram_changes.empty() ? vram : frame_vram, frame_registers,
+                   changes, vram_changes, drawn, 144);
+    in_flight = true;
+    drawn = 144;
+}
+
+void Ppu::hand_over(int end) {
+    if (drawn >= end) return;
+    ZONE("render handoff");
+
+    // The worker draws into the frame it holds, so the last frame is
+    // collected first
+    if (in_flight) {
+        worker->collect(framebuffer);
+        in_flight = false;
+    }
+    worker->submit(vram_changes.empty() ? vram : frame_vram, frame_registers,
+                   changes, vram_changes, drawn, end);
+
+    // Changes logged for line end are already in the registers and VRAM
+    frame_registers = registers();
+    line_registers = frame_registers;
+    changes.clear();
+    vram_changes.clear();
+    applied = 0;
+    drawn = end;
+}
+
 void Ppu::render() {
+    line_registers = frame_registers;
+    applied = 0;
+    drawn = 0;
+    render_lines(144);
+}
+
+void Ppu::render_lines(int end) {
+    if (drawn >= end) return;
+    ZONE("render");
+
+    draw_lines(framebuffer.data(), vram.data(), tileset, line_registers,
+               changes, applied, drawn, end);
+    drawn = end;
+}
+
+void Ppu::draw_lines(Pixel* framebuffer, const uint8_t* vram,
+                     const Tileset& tileset, RenderRegisters& registers,
+                     const std::vector<RegisterChange>& changes,
+                     size_t& applied, int first, int end) {
+    for (int line = first; line < end; ++line) {
+        while (applied < changes.size() && changes[applied].line <= line) {
+            apply(registers, changes[applied].reg, changes[applied].value);
+            ++applied;
+        }
+        draw_line(framebuffer, line, registers, vram, tileset);
+    }
+}
+
+void Ppu::draw_line(Pixel* framebuffer, int line, const RenderRegisters& r,
+                    const uint8_t* vram, const Tileset& tileset) {
     // Which tilemap is being used
-    uint16_t map_offset = bg_map ? 0x1c00 : 0x1800;
+    uint16_t map_offset = r.bg_map ? 0x1c00 : 0x1800;
 
     // Which line of tiles is being used
-    map_offset += ((scanline + scy) & 0xff) >> 3;
+    map_offset += (((line + r.scy) & 0xff) >> 3) << 5;
 
     // Which tile to begin with
-    uint8_t line_offset = scx >> 3;
+    uint8_t line_offset = r.scx >> 3;
 
     // Which line of pixels is being used
-    int y = (scanline + scy) & 7;
+    int y = (line + r.scy) & 7;
 
     // Where in tile line to begin
-    int x = scx & 7;
+    int x = r.scx & 7;
 
     // Where to render on the screen
-    int screen_offset = scanline * 160;
+    Pixel* out = framebuffer + line * 160;
 
-    // Get tile from background map
-    uint8_t tile = vram.at(map_offset + line_offset);
+    // Tile data at $8000 is indexed unsigned (tiles 0-255). At $8800 it
+    // is indexed signed from $9000 (tiles 128-383).
+    auto tile_index = [&](uint8_t tile) {
+        return r.bg_tile ? tile : 256 + static_cast<int8_t>(tile);
+    };
 
-    // Tiles are signed if Tile Map 1 is in use
-    uint8_t tile_0  = tile;
-    int8_t  tile_1  = static_cast<int8_t>(tile);
+    const Tile* tile = &tileset[tile_index(vram[map_offset + line_offset])];
 
     for (int i = 0; i < 160; ++i) {
-        Pixel pixel;
-        
-        // Determine if pixel has signed or unsigned value
-        if (bg_map) {
-            pixel = tileset.at(tile_1).at(y).at(x);
-        } else {
-            pixel = tileset.at(tile_0).at(y).at(x);
-        }
-
         // Write pixel to LCD framebuffer
-        framebuffer.at(screen_offset) = pixel; 
+        out[i] = (*tile)[y][x];
 
-        ++screen_offset;
-
-        // Increment tile counter and roceed to next tile, if necessary
+        // Increment tile counter and proceed to next tile, if necessary
         ++x;
         if (x == 8) {
             line_offset = (line_offset + 1) & 0x1f;
-            tile = vram.at(line_offset + map_offset);
+            tile = &tileset[tile_index(vram[map_offset + line_offset])];
             x = 0;
         }
     }
 }
 
-void Ppu::step_clock() {
-    // Clock to determine PPU mode
-    mode_clock += cycles;
+int Ppu::mode_length(Mode mode) {
+    static const int LENGTHS[4] = {204, 456, 80, 172};
+    return LENGTHS[mode];
+}
 
+void Ppu::next_mode() {
     // Counts current line. Ranges from 0-153, where 144-153 are
     // for the vblank period.
 
@@ -136,52 +337,95 @@ void Ppu::step_clock() {
 
         // Access sprite memory
         case SCANLINE_OAM:
-            if (mode_clock >= 80) {
-                mode_clock = 0;
-                mode = SCANLINE_VRAM;
-            }
+            mode = SCANLINE_VRAM;
             break;
         
         // Access video memory
         case SCANLINE_VRAM:
-            if (mode_clock >= 172) {
-                mode_clock = 0;
-                mode = HBLANK;
-
-                // Render a scanline
-                render();
-            }
+            mode = HBLANK;
             break;
 
         // After last hblank, push data to screen
         case HBLANK:
-            if (mode_clock >= 204) {
-                mode_clock = 0;
-                ++scanline;
-
-                if (scanline == 143) {
-                    mode = VBLANK;
-                    // Draw to screen
-                    draw(framebuffer);
-                } else {
-                    mode = SCANLINE_OAM;
-                }
+            ++scanline;
+
+            if (scanline == 144) {
+                // Frame is complete; draw it for the frontend to present
+                finish_frame();
+                mode = VBLANK;
+                mmu->request_interrupt(INT_VBLANK);
+            } else {
+                mode = SCANLINE_OAM;
             }
             break;
 
         case VBLANK:
-            if (mode_clock >= 456) {
-                mode_clock = 0;
-                ++scanline;
-
-                // Return to top of screen
-                if (scanline > 153) {
-                    mode = SCANLINE_OAM;
-                    scanline = 0;
-                }
+            ++scanline;
+
+            // Return to top of screen
+            if (scanline > 153) {
+                mode = SCANLINE_OAM;
+                scanline = 0;
+                begin_frame();
             }
             break;
     }
+}
+
+void Ppu::catch_up() {
+    uint64_t now = cpu->clock();
+    if (now <= synced) return;
+
+    // Whole modes first, carrying over the cycles past each one's end
+    uint64_t cycles = now - synced;
+    synced = now;
+    while (cycles >= uint64_t(mode_length() - mode_clock)) {
+        cycles -= mode_length() - mode_clock;
+        mode_clock = 0;
+        next_mode();
+    }
+    mode_clock += cycles;
+
+    if (now >= event) schedule();
+}
+
+Ppu::Timing Ppu::timing() const {
+    // catch_up's walk through the modes, on copies and without drawing
+    Mode m = mode;
+    int clock = mode_clock;
+    int line = scanline;
+    uint64_t now = cpu->clock();
+    uint64_t cycles = now > synced ? now - synced : 0;
+    while (cycles >= uint64_t(mode_length(m) - clock)) {
+        cycles -= mode_length(m) - clock;
+        clock = 0;
+        switch (m) {
+            case SCANLINE_OAM:  m = SCANLINE_VRAM; break;
+            case SCANLINE_VRAM: m = HBLANK; break;
+            case HBLANK:
+                ++line;
+                m = line == 144 ? VBLANK : SCANLINE_OAM;
+                break;
+            case VBLANK:
+                if (++line > 153) {
+                    m = SCANLINE_OAM;
+                    line = 0;
+                }
+                break;
+        }
+    }
+    return {static_cast<uint8_t>(m), clock + static_cast<int>(cycles),
+            static_cast<uint8_t>(line)};
+}
 
-    //std::cout << (int)scanline << std::endl;
-}
\ No newline at end of file
+void Ppu::schedule() {
+    // Cycles left in the current line, then whole lines up to line 144
+    // of this frame or, during VBlank, of the next
+    const int LINE = 456;
+    int line_clock = mode_clock;
+    if (mode == SCANLINE_VRAM) line_clock += 80;
+    if (mode == HBLANK) line_clock += 80 + 172;
+
+    int lines = mode == VBLANK ? 153 - scanline + 144 : 143 - scanline;
+    event = synced + (LINE - line_clock) + uint64_t(lines) * LINE;
+}
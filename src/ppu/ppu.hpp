@@ -1,12 +1,18 @@
 #ifndef PPU_HPP
 #define PPU_HPP
 #include <array>
-#include <SDL2/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+class Cpu;
+class Mmu;
+class RenderWorker;
+struct State;
 
 // Pixel type
 // A pixel is 2-bits in size, so there are 4 possible color values.
-// Pixels are mapped to the appropriate SDL Uint32 color values.
-enum Pixel: Uint32 {
+// Pixels are mapped to ARGB8888 color values, as used by SDL.
+enum Pixel: uint32_t {
     BLACK      = 0xff000000,
     DARK_GRAY  = 0xff606060,
     LIGHT_GRAY = 0xffc0c0c0,
@@ -14,16 +20,36 @@ enum Pixel: Uint32 {
 };
 
 class Ppu {
+    // Draws frames with the same functions, on VRAM copies
+    friend class RenderWorker;
+
     private:
+        // Provides the clock; receives interrupt requests
+        Cpu* cpu;
+        Mmu* mmu;
+
         // Video RAM
         std::array<uint8_t, 8192> vram;
 
         // Modes for different timings
         enum Mode {HBLANK, VBLANK, SCANLINE_OAM, SCANLINE_VRAM} mode;
 
-        // Totals number of cycles from CPU to determine mode
+        // Cycles spent in the current mode
         int mode_clock;
 
+        // CPU clock the PPU has been emulated up to
+        uint64_t synced;
+
+        // Cycles each mode lasts
+        static int mode_length(Mode);
+        int mode_length() const { return mode_length(mode); }
+
+        // Enter the next mode once the current one has run its length
+        void next_mode();
+
+        // Recompute event
+        void schedule();
+
         // A tile is made up of 8 * 8 pixels
         typedef std::array<std::array<Pixel, 8>, 8> Tile;
 
@@ -32,15 +58,97 @@ class Ppu {
         // Tiles 128-384 may be indexed with signed ints. (-128 - 127)
         // Tiles 128-255 may be indexed as signed or unsigned ints; the 
         // addresses are shared between the two indexing modes.
-        std::array<Tile, 384> tileset;
+        typedef std::array<Tile, 384> Tileset;
+        Tileset tileset;
 
-        // Render one scanline
-        void render();
+        // Decode the tile row containing addr into the tileset
+        void update_tile(uint16_t addr) { decode_tile(tileset, vram.data(), addr); }
+        static void decode_tile(Tileset&, const uint8_t*, uint16_t);
+
+        // Deferred rendering
+        // Lines are drawn in one pass on entering VBlank rather than one
+        // at a time. Writes to the registers below during active display
+        // are logged with the first line they apply to, and replayed as
+        // the pass reaches that line, so raster effects still land on the
+        // right lines. A VRAM write during active display draws the lines
+        // before it first or, when a worker draws the frame, is logged
+        // too, against a copy of VRAM taken at the first such write.
+
+        // Registers that affect rendering
+        struct RenderRegisters {
+            bool bg_map;
+            bool bg_tile;
+            uint8_t scy;
+            uint8_t scx;
+            uint8_t palette;
+        };
+
+        // A register write, by the low byte of its address
+        struct RegisterChange {
+            uint8_t line;
+            uint8_t reg;
+            uint8_t value;
+        };
+
+        // A VRAM write, by its offset into VRAM
+        struct VramChange {
+            uint8_t line;
+            uint16_t addr;
+            uint8_t value;
+        };
+
+        // Registers at the start of the frame (or, with a worker, of the
+        // first line not yet handed to it), and as of the next line to draw
+        RenderRegisters frame_registers;
+        RenderRegisters line_registers;
+
+        // This frame's changes, and how many have been applied so far
+        std::vector<RegisterChange> changes;
+        size_t applied;
+
+        // With a worker, VRAM as of the first write during active display
+        // and the writes from then on
+        std::array<uint8_t, 8192> frame_vram;
+        std::vector<VramChange> vram_changes;
+
+        // Lines of this frame drawn, or handed to the worker, so far
+        int drawn;
+
+        RenderRegisters registers() const;
+        static void apply(RenderRegisters&, uint8_t, uint8_t);
+
+        // First line a write made now would show on; 144 during VBlank
+        int next_line() const;
+
+        // Start a frame with the current registers
+        void begin_frame();
+
+        // Draw the frame on entering VBlank, or hand it to the worker
+        void finish_frame();
+
+        // Hand the worker the lines of this frame up to end and start the
+        // logs again from there. The worker keeps the lines it has drawn.
+        void hand_over(int);
+
+        // A frame handed to the worker is collected at the next VBlank
+        bool in_flight;
+
+        // Draw the lines of this frame up to end
+        void render_lines(int);
+
+        // Draw lines [first, end) from VRAM and its decoded tiles,
+        // applying changes from index applied on as their lines are reached
+        static void draw_lines(Pixel*, const uint8_t*, const Tileset&,
+                               RenderRegisters&,
+                               const std::vector<RegisterChange>&,
+                               size_t& applied, int first, int end);
+        static void draw_line(Pixel*, int, const RenderRegisters&,
+                              const uint8_t*, const Tileset&);
 
     public:
         // Registers
-        // When the CPU reads/writes to these registers, the MMU
-        // redirects the value to/from these variables.
+        // When the CPU reads these registers, the MMU redirects the value
+        // from these variables. Writes go through write_register().
         bool bg_switch;
         bool bg_map;
         bool bg_tile;
@@ -50,17 +158,57 @@ class Ppu {
         uint8_t scanline;
         uint8_t palette;
 
-        // Cycle counter (passed from CPU by dispatcher)
-        int cycles;
-        
+        // Clock at which the PPU next requests an interrupt (VBlank).
+        // Until then it only runs when catch_up() is called.
+        uint64_t event;
+
+        // Dirty page tracking
+        // Each bit marks a 256-byte page of VRAM written since the bits
+        // were last cleared.
+        uint32_t dirty;
+
         // Framebuffer
-        // Passed into SDL update functions as Uint32
+        // Passed into SDL update functions as ARGB8888
         std::array<Pixel, 160 * 144> framebuffer;
 
-        Ppu();
+        // Draws whole frames on another thread when set. The framebuffer
+        // then holds the frame before the last one.
+        RenderWorker* worker;
+
+        Ppu(Cpu*, Mmu*);
         uint8_t read_vram(uint16_t);
+        const uint8_t* vram_data() const { return vram.data(); }
         void write_vram(uint16_t, uint8_t);
-        void step_clock();
+
+        // Write LCDC, SCY, SCX or BGP
+        void write_register(uint16_t, uint8_t);
+
+        // Run the PPU up to the CPU's clock. The MMU calls this before
+        // LCD register, VRAM and OAM accesses, so the lines rendered so
+        // far only see the values from before the access.
+        void catch_up();
+
+        // STAT mode bits, as of the last catch_up()
+        uint8_t current_mode() const { return mode; }
+
+        // Mode, cycles into it and LY as they are at the CPU's clock,
+        // worked out without catching up, for comparing machines
+        struct Timing {
+            uint8_t mode;
+            int mode_clock;
+            uint8_t scanline;
+        };
+        Timing timing() const;
+
+        // Redraw the whole frame from its starting registers, replaying
+        // the logged changes
+        void render();
+
+        // Copy VRAM and registers to/from a save state. Saving catches up
+        // and draws the lines shown so far, as the logs aren't saved;
+        // loading carries on from the next line.
+        void save_state(State&);
+        void load_state(const State&);
 };
 
 #endif // PPU_HPP
\ No newline at end of file
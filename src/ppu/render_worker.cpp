@@ -0,0 +1,106 @@
+#include <algorithm>
+#include "render_worker.hpp"
+#include "../profile/zones.hpp"
+
+RenderWorker::RenderWorker()
+    : busy {false}, quit {false}, first {0}, end {0}
+{
+    changes.reserve(256);
+    vram_changes.reserve(1024);
+
+    // Match the decoded tiles to all-zero VRAM, as the PPU does
+    decoded.fill(0);
+    for (uint16_t addr = 0; addr < 0x1800; addr += 2) {
+        Ppu::decode_tile(tileset, decoded.data(), addr);
+    }
+    framebuffer.fill(WHITE);
+
+    thread = std::thread(&RenderWorker::run, this);
+}
+
+RenderWorker::~RenderWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void RenderWorker::submit(const std::array<uint8_t, 8192>& frame_vram,
+                          const Ppu::RenderRegisters& frame_registers,
+                          const std::vector<Ppu::RegisterChange>& frame_changes,
+                          const std::vector<Ppu::VramChange>& frame_vram_changes,
+                          int first_line, int end_line) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return !busy; });
+        first = first_line;
+        end = end_line;
+        vram = frame_vram;
+        registers = frame_registers;
+        changes = frame_changes;
+        vram_changes = frame_vram_changes;
+        busy = true;
+    }
+    wake.notify_one();
+}
+
+void RenderWorker::collect(std::array<Pixel, 160 * 144>& out) {
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return !busy; });
+    out = framebuffer;
+}
+
+void RenderWorker::run() {
+    name_zone_thread("render");
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return busy || quit; });
+        if (quit) return;
+
+        // The job is only touched by this thread until busy is cleared
+        lock.unlock();
+        draw();
+        lock.lock();
+
+        busy = false;
+        done.notify_one();
+    }
+}
+
+void RenderWorker::draw() {
+    ZONE("render");
+
+    for (uint16_t addr = 0; addr < 0x1800; addr += 2) {
+        if (vram[addr] != decoded[addr] || vram[addr + 1] != decoded[addr + 1]) {
+            decoded[addr] = vram[addr];
+            decoded[addr + 1] = vram[addr + 1];
+            Ppu::decode_tile(tileset, decoded.data(), addr);
+        }
+    }
+
+    // Draw up to each line VRAM was written at, then apply the writes
+    size_t applied = 0;
+    size_t written = 0;
+    int line = first;
+    while (line < end) {
+        int next = written < vram_changes.size()
+                   ? std::min<int>(vram_changes[written].line, end) : end;
+        Ppu::draw_lines(framebuffer.data(), vram.data(), tileset, registers,
+                        changes, applied, line, next);
+        line = next;
+
+        while (written < vram_changes.size() &&
+               vram_changes[written].line == line) {
+            const Ppu::VramChange& change = vram_changes[written];
+            vram[change.addr] = change.value;
+            decoded[change.addr] = change.value;
+            if (change.addr < 0x1800) {
+                Ppu::decode_tile(tileset, decoded.data(), change.addr);
+            }
+            ++written;
+        }
+    }
+}
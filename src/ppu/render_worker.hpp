@@ -0,0 +1,69 @@
+#ifndef RENDER_WORKER_HPP
+#define RENDER_WORKER_HPP
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ppu.hpp"
+
+// Render worker
+// Draws frames on a thread of its own. On entering VBlank the PPU hands
+// over a copy of VRAM with the frame's starting registers and change
+// logs, and the CPU goes on emulating the next frame while the worker
+// draws. VRAM written during the frame is handed over as it was before
+// the first write, and the writes are replayed at their lines.
+// The finished frame is collected at the following VBlank, so frames are
+// presented one frame late. A frame can be handed over in parts, as when
+// a state is saved mid-frame; lines outside a part keep what the worker
+// last drew there.
+
+class RenderWorker {
+    private:
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+        bool busy;
+        bool quit;
+
+        // The frame being drawn, lines [first, end)
+        int first;
+        int end;
+        std::array<uint8_t, 8192> vram;
+        Ppu::RenderRegisters registers;
+        std::vector<Ppu::RegisterChange> changes;
+        std::vector<Ppu::VramChange> vram_changes;
+
+        // Tiles decoded from vram, and the VRAM they were decoded from,
+        // so only tile rows that changed between frames are decoded again
+        Ppu::Tileset tileset;
+        std::array<uint8_t, 8192> decoded;
+
+        std::array<Pixel, 160 * 144> framebuffer;
+
+        void run();
+        void draw();
+
+    public:
+        RenderWorker();
+        ~RenderWorker();
+
+        RenderWorker(const RenderWorker&) = delete;
+        RenderWorker& operator=(const RenderWorker&) = delete;
+
+        // Start drawing lines [first, end) of a frame from VRAM and the
+        // registers as of line first. Waits for the previous job to finish.
+        void submit(const std::array<uint8_t, 8192>&,
+                    const Ppu::RenderRegisters&,
+                    const std::vector<Ppu::RegisterChange>&,
+                    const std::vector<Ppu::VramChange>&,
+                    int first, int end);
+
+        // Wait for the frame being drawn and copy it out
+        void collect(std::array<Pixel, 160 * 144>&);
+};
+
+#endif // RENDER_WORKER_HPP
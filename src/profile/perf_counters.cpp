@@ -0,0 +1,151 @@
+#include <iomanip>
+#include <iostream>
+#include "perf_counters.hpp"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char* perf_event_name(PerfEvent event) {
+    switch (event) {
+        case PerfEvent::CYCLES: return "cycles";
+        case PerfEvent::INSTRUCTIONS: return "instructions";
+        case PerfEvent::BRANCH_MISSES: return "branch_misses";
+        case PerfEvent::L1D_MISSES: return "l1d_misses";
+        case PerfEvent::LLC_MISSES: return "llc_misses";
+    }
+    return "";
+}
+
+PerfCounters::PerfCounters() {
+    fds.fill(-1);
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int fd : fds) {
+        if (fd >= 0) close(fd);
+    }
+#endif
+}
+
+#ifdef __linux__
+// Type and config of each event for perf_event_open
+static void describe(PerfEvent event, perf_event_attr& attr) {
+    const uint64_t CACHE_READ_MISS = (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    switch (event) {
+        case PerfEvent::CYCLES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PerfEvent::INSTRUCTIONS:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PerfEvent::BRANCH_MISSES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case PerfEvent::L1D_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | CACHE_READ_MISS;
+            break;
+        case PerfEvent::LLC_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_LL | CACHE_READ_MISS;
+            break;
+    }
+}
+#endif
+
+bool PerfCounters::open() {
+    bool any = false;
+#ifdef __linux__
+    for (int i = 0; i < PERF_EVENTS; ++i) {
+        if (fds[i] >= 0) close(fds[i]);
+
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        describe(static_cast<PerfEvent>(i), attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // This thread, on any CPU
+        fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        any = any || fds[i] >= 0;
+    }
+#endif
+    return any;
+}
+
+bool PerfCounters::available(PerfEvent event) const {
+    return fds[static_cast<int>(event)] >= 0;
+}
+
+void PerfCounters::start() {
+#ifdef __linux__
+    for (int fd : fds) {
+        if (fd < 0) continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+void PerfCounters::stop() {
+#ifdef __linux__
+    for (int fd : fds) {
+        if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+#endif
+}
+
+int64_t PerfCounters::read(PerfEvent event) const {
+#ifdef __linux__
+    int fd = fds[static_cast<int>(event)];
+    if (fd < 0) return -1;
+
+    // Value, time enabled, time running
+    uint64_t values[3];
+    if (::read(fd, values, sizeof(values)) != sizeof(values)) return -1;
+    if (values[2] == 0) return 0;
+    if (values[2] < values[1]) {
+        return static_cast<int64_t>(
+            static_cast<double>(values[0]) * values[1] / values[2]);
+    }
+    return values[0];
+#else
+    return -1;
+#endif
+}
+
+void PerfCounters::report(std::ostream& out, uint64_t instructions,
+                          uint64_t frames) const {
+    out << "Host counters     per instruction     per frame" << std::endl;
+    for (int i = 0; i < PERF_EVENTS; ++i) {
+        PerfEvent event = static_cast<PerfEvent>(i);
+        out << "  " << std::left << std::setw(14) << perf_event_name(event)
+            << std::right;
+
+        int64_t count = read(event);
+        if (count < 0) {
+            out << "      unavailable" << std::endl;
+            continue;
+        }
+        out << std::fixed << std::setprecision(3)
+            << std::setw(17) << (instructions ? double(count) / instructions : 0.0)
+            << std::setprecision(0)
+            << std::setw(14) << (frames ? double(count) / frames : 0.0)
+            << std::endl;
+    }
+    out << std::defaultfloat << std::setprecision(6);
+}
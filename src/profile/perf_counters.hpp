@@ -0,0 +1,47 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+
+// Hardware performance counters
+// Counts host cycles, instructions, branch misses and cache misses of the
+// calling thread through perf_event_open, to explain what wall time
+// alone can't. Linux only; elsewhere, or where the kernel doesn't allow
+// it (see /proc/sys/kernel/perf_event_paranoid), the counters are
+// unavailable and read as -1.
+
+enum class PerfEvent {CYCLES, INSTRUCTIONS, BRANCH_MISSES, L1D_MISSES, LLC_MISSES};
+const int PERF_EVENTS = 5;
+
+// Name of an event, for reports
+const char* perf_event_name(PerfEvent);
+
+class PerfCounters {
+    private:
+        std::array<int, PERF_EVENTS> fds;
+
+    public:
+        PerfCounters();
+        ~PerfCounters();
+
+        PerfCounters(const PerfCounters&) = delete;
+        PerfCounters& operator=(const PerfCounters&) = delete;
+
+        // Open every counter the host supports. False if none could be.
+        bool open();
+        bool available(PerfEvent) const;
+
+        // Reset and start counting, and stop again
+        void start();
+        void stop();
+
+        // Count since start(), scaled up if the kernel multiplexed the
+        // counter, or -1 if it isn't available
+        int64_t read(PerfEvent) const;
+
+        // Print each count per emulated instruction and per frame
+        void report(std::ostream&, uint64_t instructions, uint64_t frames) const;
+};
+
+#endif // PERF_COUNTERS_HPP
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include "profiler.hpp"
+#include "../cpu/disassembler.hpp"
+#include "../mmu/mmu.hpp"
+
+Profiler::Profiler() : pc_count(65536), pc_cycles(65536), enabled {true} {
+    reset();
+}
+
+void Profiler::reset() {
+    op_count.fill(0);
+    op_cycles.fill(0);
+    std::fill(pc_count.begin(), pc_count.end(), 0);
+    std::fill(pc_cycles.begin(), pc_cycles.end(), 0);
+}
+
+// Indices of the non-zero entries of counts, hottest first, at most top
+static std::vector<int> hottest(const uint64_t* cycles, const uint64_t* counts,
+                                int size, int top) {
+    std::vector<int> indices;
+    for (int i = 0; i < size; ++i) {
+        if (counts[i]) indices.push_back(i);
+    }
+
+    int n = std::min<int>(top, indices.size());
+    std::partial_sort(indices.begin(), indices.begin() + n, indices.end(),
+                      [=](int a, int b) { return cycles[a] > cycles[b]; });
+    indices.resize(n);
+    return indices;
+}
+
+void Profiler::report(std::ostream& out, Mmu& mmu, int top) const {
+    uint64_t total = std::accumulate(op_cycles.begin(), op_cycles.end(),
+                                     uint64_t(0));
+    if (total == 0) {
+        out << "No instructions profiled." << std::endl;
+        return;
+    }
+
+    auto percent = [=](uint64_t cycles) { return 100.0 * cycles / total; };
+
+    out << "Hottest opcodes by cycles (" << total << " total)" << std::endl;
+    // Average cycles per execution next to the opcode table's timing, so
+    // instructions whose memory accesses are mistimed stand out
+    out << "  opcode      count         cycles       %   avg  table  mnemonic"
+        << std::endl;
+    for (int op : hottest(op_cycles.data(), op_count.data(), 512, top)) {
+        // Disassemble with zeroed operands
+        uint8_t bytes[3] = {0, 0, 0};
+        if (op > 0xff) {
+            bytes[0] = 0xcb;
+            bytes[1] = op & 0xff;
+        } else {
+            bytes[0] = op;
+        }
+
+        out << std::dec << "  " << (op > 0xff ? "cb " : "   ")
+            << std::hex << std::setw(2) << std::setfill('0') << (op & 0xff)
+            << std::dec << std::setfill(' ')
+            << std::setw(13) << op_count[op]
+            << std::setw(15) << op_cycles[op]
+            << std::setw(8) << std::fixed << std::setprecision(2)
+            << percent(op_cycles[op])
+            << std::setw(6) << std::setprecision(1)
+            << static_cast<double>(op_cycles[op]) / op_count[op]
+            << std::setw(4) << static_cast<int>(OPCODES[op].cycles);
+        if (OPCODES[op].cycles_taken != OPCODES[op].cycles) {
+            out << "/" << std::setw(2) << std::left
+                << static_cast<int>(OPCODES[op].cycles_taken) << std::right;
+        } else {
+            out << "   ";
+        }
+
+        char mnemonic[DISASSEMBLY_SIZE];
+        disassemble(mnemonic, bytes);
+        out << "  " << mnemonic << std::endl;
+    }
+
+    out << std::dec << std::setfill(' ') << std::endl;
+    out << "Hottest addresses by cycles" << std::endl;
+    out << "  bank:addr      count         cycles       %  instruction" << std::endl;
+    for (int pc : hottest(pc_cycles.data(), pc_count.data(), 65536, top)) {
+        uint8_t bytes[3];
+        for (int k = 0; k < 3; ++k) {
+            bytes[k] = mmu.at((pc + k) & 0xffff);
+        }
+
+        // Without a memory bank controller, $4000-$7fff is always bank 1
+        out << "  " << (pc < 0x4000 ? "00" : pc < 0x8000 ? "01" : "--") << ":"
+            << std::hex << std::setw(4) << std::setfill('0') << pc
+            << std::dec << std::setfill(' ')
+            << std::setw(11) << pc_count[pc]
+            << std::setw(15) << pc_cycles[pc]
+            << std::setw(8) << std::fixed << std::setprecision(2)
+            << percent(pc_cycles[pc]) << "  ";
+
+        char mnemonic[DISASSEMBLY_SIZE];
+        disassemble(mnemonic, bytes, pc);
+        out << mnemonic << std::endl;
+    }
+    out << std::dec << std::setfill(' ');
+}
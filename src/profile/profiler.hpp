@@ -0,0 +1,45 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+class Mmu;
+
+// Execution profiler
+// Counts executions and cycles per opcode and per address. The CPU only
+// records into it when built with RUGBE_PROFILE (make PROFILE=1), so it
+// costs nothing otherwise.
+
+class Profiler {
+    public:
+        // Opcodes 0x00-0xff, then CB-prefixed opcodes at 0x100-0x1ff
+        std::array<uint64_t, 512> op_count;
+        std::array<uint64_t, 512> op_cycles;
+
+        // Indexed by the address of the instruction
+        std::vector<uint64_t> pc_count;
+        std::vector<uint64_t> pc_cycles;
+
+        // Cleared to ignore instructions, as run-ahead does for frames it
+        // rolls back
+        bool enabled;
+
+        Profiler();
+
+        void record(uint16_t pc, uint16_t op, int cycles) {
+            if (!enabled) return;
+            ++op_count[op];
+            op_cycles[op] += cycles;
+            ++pc_count[pc];
+            pc_cycles[pc] += cycles;
+        }
+
+        void reset();
+
+        // Print the hottest opcodes and addresses by cycles, with the
+        // instruction currently in memory at each address
+        void report(std::ostream&, Mmu&, int top = 20) const;
+};
+
+#endif // PROFILER_HPP
@@ -0,0 +1,120 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "zones.hpp"
+
+// Zones kept per thread; later ones are dropped
+const size_t ZONE_CAPACITY = 1 << 18;
+
+struct ZoneEvent {
+    const char* name;
+
+    // Nanoseconds since the first zone
+    uint64_t start;
+    uint64_t end;
+};
+
+// Written only by its thread. count is published with a release store
+// after each event, so write_zones() can read the events before it from
+// another thread.
+struct ZoneBuffer {
+    int tid;
+    std::string thread_name;
+    std::vector<ZoneEvent> events;
+    std::atomic<size_t> count;
+    std::atomic<uint64_t> dropped;
+
+    ZoneBuffer(int tid)
+        : tid {tid}, events(ZONE_CAPACITY), count {0}, dropped {0} {}
+};
+
+// Buffers outlive their threads so zones can be written after a thread
+// exits. The mutex only guards the list, not the buffers.
+static std::mutex buffers_mutex;
+static std::vector<std::unique_ptr<ZoneBuffer>> buffers;
+static thread_local ZoneBuffer* thread_buffer = nullptr;
+
+static ZoneBuffer* get_buffer() {
+    if (thread_buffer == nullptr) {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        buffers.push_back(std::make_unique<ZoneBuffer>(buffers.size() + 1));
+        thread_buffer = buffers.back().get();
+    }
+    return thread_buffer;
+}
+
+static uint64_t now() {
+    static const auto epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - epoch).count();
+}
+
+Zone::Zone(const char* name) : name {name}, start {now()} {}
+
+Zone::~Zone() {
+    uint64_t end = now();
+    ZoneBuffer* buffer = get_buffer();
+
+    size_t count = buffer->count.load(std::memory_order_relaxed);
+    if (count == ZONE_CAPACITY) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[count] = {name, start, end};
+    buffer->count.store(count + 1, std::memory_order_release);
+}
+
+#ifdef RUGBE_ZONES
+void name_zone_thread(const char* name) {
+    ZoneBuffer* buffer = get_buffer();
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    buffer->thread_name = name;
+}
+#endif
+
+bool write_zones(const char* filepath) {
+    std::ofstream file(filepath, std::ios::trunc);
+    if (!file) return false;
+
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    file << std::fixed << std::setprecision(3)
+         << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+    bool first = true;
+    auto separate = [&]() {
+        file << (first ? "" : ",\n");
+        first = false;
+    };
+
+    for (const auto& buffer : buffers) {
+        if (!buffer->thread_name.empty()) {
+            separate();
+            file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, "
+                 << "\"tid\": " << buffer->tid << ", \"args\": {\"name\": \""
+                 << buffer->thread_name << "\"}}";
+        }
+
+        // Complete events, with times in microseconds
+        size_t count = buffer->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            const ZoneEvent& event = buffer->events[i];
+            separate();
+            file << "{\"name\": \"" << event.name << "\", \"ph\": \"X\", "
+                 << "\"pid\": 1, \"tid\": " << buffer->tid << ", "
+                 << "\"ts\": " << event.start / 1000.0 << ", "
+                 << "\"dur\": " << (event.end - event.start) / 1000.0 << "}";
+        }
+    }
+
+    uint64_t dropped = 0;
+    for (const auto& buffer : buffers) {
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    file << "\n], \"otherData\": {\"dropped_zones\": " << dropped << "}}\n";
+    return static_cast<bool>(file);
+}
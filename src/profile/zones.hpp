@@ -0,0 +1,45 @@
+#ifndef ZONES_HPP
+#define ZONES_HPP
+#include <cstdint>
+
+// Instrumentation zones
+// ZONE("name") times the rest of the enclosing scope into a buffer owned
+// by the calling thread, so recording never takes a lock. write_zones()
+// exports every thread's zones as Chrome trace_event JSON, which
+// chrome://tracing and Perfetto load, to find which stage made a frame
+// slow. Zones are only compiled in with RUGBE_ZONES (make ZONES=1);
+// otherwise ZONE() expands to nothing. Names must be string literals.
+
+class Zone {
+    private:
+        const char* name;
+        uint64_t start;
+
+    public:
+        Zone(const char*);
+        ~Zone();
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+};
+
+// Name the calling thread in exported traces. Naming a thread gives it a
+// zone buffer, so without zones compiled in it does nothing.
+#ifdef RUGBE_ZONES
+void name_zone_thread(const char*);
+#else
+inline void name_zone_thread(const char*) {}
+#endif
+
+// Write the zones recorded so far by every thread
+bool write_zones(const char* filepath);
+
+#ifdef RUGBE_ZONES
+#define ZONE_NAME2(line) zone_##line
+#define ZONE_NAME(line) ZONE_NAME2(line)
+#define ZONE(name) Zone ZONE_NAME(__LINE__)(name)
+#else
+#define ZONE(name)
+#endif
+
+#endif // ZONES_HPP
@@ -0,0 +1,242 @@
+#include <cstring>
+#include "rewind.hpp"
+#include "../gameboy.hpp"
+
+// Page size and count for each region
+const size_t PAGE_SIZE    = 256;
+const int    MEMORY_PAGES = sizeof(State::memory) / PAGE_SIZE;
+const int    VRAM_PAGES   = 8192 / PAGE_SIZE;
+
+// Page header: region, index. The high bit of the region byte marks
+// a compressed page.
+const uint8_t REGION_MEMORY = 0x00;
+const uint8_t REGION_VRAM   = 0x01;
+const uint8_t COMPRESSED    = 0x80;
+
+// Record header: register state, then the page count
+const size_t CPU_OFFSET    = 0;
+const size_t PPU_OFFSET    = CPU_OFFSET + sizeof(CpuState);
+const size_t JOYPAD_OFFSET = PPU_OFFSET + sizeof(PpuState);
+const size_t TIMER_OFFSET  = JOYPAD_OFFSET + sizeof(JoypadState);
+const size_t APU_OFFSET    = TIMER_OFFSET + sizeof(TimerState);
+const size_t COUNT_OFFSET  = APU_OFFSET + sizeof(ApuState);
+const size_t RECORD_HEADER = COUNT_OFFSET + 2;
+
+// Largest possible record: header and every page stored raw, plus room
+// for a compression attempt to overrun the last page
+const size_t MAX_RECORD    = RECORD_HEADER +
+                             (MEMORY_PAGES + VRAM_PAGES) * (2 + PAGE_SIZE) +
+                             PAGE_SIZE * 2;
+
+Rewind::Rewind(GameBoy* gb, size_t budget, bool compress)
+    : gb {gb}, compress {compress}, buffer(budget), head {0}, scratch(MAX_RECORD)
+{
+    reset();
+}
+
+void Rewind::clear_dirty() {
+    gb->mmu.dirty.fill(0);
+    gb->ppu.dirty = 0;
+}
+
+void Rewind::reset() {
+    records.clear();
+    head = 0;
+    gb->save_state(shadow);
+    clear_dirty();
+}
+
+// Append a page to the record being built if it changed, and bring the
+// shadow copy up to date
+void Rewind::store_page(size_t& size, uint8_t region, uint8_t index,
+                        uint8_t* old, const uint8_t* cur) {
+    if (std::memcmp(old, cur, PAGE_SIZE) == 0) return;
+
+    uint8_t* out = scratch.data() + size;
+    out[1] = index;
+
+    bool packed = false;
+    if (compress) {
+        // Encode the XOR against the new contents as (zero run, literal
+        // count, literals) tokens. Fall back to a raw page if it doesn't
+        // get any smaller.
+        size_t n = 2;
+        size_t i = 0;
+        while (i < PAGE_SIZE && n < 2 + PAGE_SIZE) {
+            uint8_t zeros = 0;
+            while (i < PAGE_SIZE && (old[i] ^ cur[i]) == 0 && zeros < 255) {
+                ++zeros;
+                ++i;
+            }
+            uint8_t literals = 0;
+            size_t start = n + 2;
+            while (i < PAGE_SIZE && (old[i] ^ cur[i]) != 0 && literals < 255) {
+                out[start + literals] = old[i] ^ cur[i];
+                ++literals;
+                ++i;
+            }
+            out[n] = zeros;
+            out[n + 1] = literals;
+            n = start + literals;
+        }
+
+        if (i == PAGE_SIZE && n < 2 + PAGE_SIZE) {
+            packed = true;
+            size += n;
+        }
+    }
+
+    if (!packed) {
+        std::memcpy(out + 2, old, PAGE_SIZE);
+        size += 2 + PAGE_SIZE;
+    }
+    out[0] = region | (packed ? COMPRESSED : 0);
+
+    std::memcpy(old, cur, PAGE_SIZE);
+}
+
+void Rewind::push() {
+    uint8_t* out = scratch.data();
+
+    // Registers as of the previous frame
+    std::memcpy(out + CPU_OFFSET, &shadow.cpu, sizeof(CpuState));
+    std::memcpy(out + PPU_OFFSET, &shadow.ppu, sizeof(PpuState));
+    std::memcpy(out + JOYPAD_OFFSET, &shadow.joypad, sizeof(JoypadState));
+    std::memcpy(out + TIMER_OFFSET, &shadow.timer, sizeof(TimerState));
+    std::memcpy(out + APU_OFFSET, &shadow.apu, sizeof(ApuState));
+
+    size_t size = RECORD_HEADER;
+    uint16_t count = 0;
+
+    // Store the previous contents of every page written this frame
+    for (int word = 0; word < 4; ++word) {
+        uint64_t bits = gb->mmu.dirty.at(word);
+        while (bits) {
+            int n = word * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+
+            size_t before = size;
+            store_page(size, REGION_MEMORY, n,
+                       &shadow.memory.at(n * PAGE_SIZE - STATE_MEMORY_BASE),
+                       &gb->mmu.at(n * PAGE_SIZE));
+            if (size != before) ++count;
+        }
+    }
+    uint32_t vram_bits = gb->ppu.dirty;
+    while (vram_bits) {
+        int n = __builtin_ctz(vram_bits);
+        vram_bits &= vram_bits - 1;
+
+        size_t before = size;
+        store_page(size, REGION_VRAM, n,
+                   &shadow.vram.at(n * PAGE_SIZE),
+                   gb->ppu.vram_data() + n * PAGE_SIZE);
+        if (size != before) ++count;
+    }
+    std::memcpy(out + COUNT_OFFSET, &count, 2);
+
+    // Shadow now holds the current frame
+    gb->cpu.save_state(shadow.cpu);
+    gb->ppu.save_state(shadow);
+    gb->joypad.save_state(shadow.joypad);
+    gb->timer.save_state(shadow.timer);
+    gb->apu.save_state(shadow.apu);
+    clear_dirty();
+
+    // A record larger than the whole budget can't be kept, and without it
+    // none of the older ones can be reached either
+    if (size > buffer.size()) {
+        records.clear();
+        head = 0;
+        return;
+    }
+
+    // Wrap around, dropping what is left of the previous lap
+    if (head + size > buffer.size()) {
+        while (!records.empty() && records.front().offset >= head) {
+            records.pop_front();
+        }
+        head = 0;
+    }
+
+    // Drop the oldest frames until the new record fits
+    while (!records.empty() && records.front().offset < head + size &&
+           records.front().offset + records.front().size > head) {
+        records.pop_front();
+    }
+
+    std::memcpy(buffer.data() + head, out, size);
+    records.push_back({head, size});
+    head += size;
+}
+
+bool Rewind::rewind() {
+    if (records.empty()) return false;
+
+    Record record = records.back();
+    records.pop_back();
+    head = record.offset;
+
+    const uint8_t* in = buffer.data() + record.offset;
+    std::memcpy(&shadow.cpu, in + CPU_OFFSET, sizeof(CpuState));
+    std::memcpy(&shadow.ppu, in + PPU_OFFSET, sizeof(PpuState));
+    std::memcpy(&shadow.joypad, in + JOYPAD_OFFSET, sizeof(JoypadState));
+    std::memcpy(&shadow.timer, in + TIMER_OFFSET, sizeof(TimerState));
+    std::memcpy(&shadow.apu, in + APU_OFFSET, sizeof(ApuState));
+
+    uint16_t count;
+    std::memcpy(&count, in + COUNT_OFFSET, 2);
+    in += RECORD_HEADER;
+
+    // Put back the previous contents of each page
+    for (int p = 0; p < count; ++p) {
+        uint8_t region = in[0];
+        uint8_t index = in[1];
+        in += 2;
+
+        uint8_t* page = (region & ~COMPRESSED) == REGION_VRAM
+                      ? &shadow.vram.at(index * PAGE_SIZE)
+                      : &shadow.memory.at(index * PAGE_SIZE - STATE_MEMORY_BASE);
+
+        if (region & COMPRESSED) {
+            size_t i = 0;
+            while (i < PAGE_SIZE) {
+                uint8_t zeros = in[0];
+                uint8_t literals = in[1];
+                in += 2;
+                i += zeros;
+                for (int l = 0; l < literals; ++l) {
+                    page[i++] ^= *in++;
+                }
+            }
+        } else {
+            std::memcpy(page, in, PAGE_SIZE);
+            in += PAGE_SIZE;
+        }
+    }
+
+    gb->load_state(shadow);
+    clear_dirty();
+    return true;
+}
+
+bool Rewind::step_back() {
+    // With a single frame left there is nothing to redraw it from
+    if (records.size() < 2) return rewind();
+    rewind();
+    rewind();
+
+    // Emulate the frame again from the buttons it started with, without
+    // sampling the host or making a sound
+    std::function<uint8_t()> poll = std::move(gb->joypad.poll);
+    gb->joypad.poll = nullptr;
+    bool audio = gb->apu.output_enabled();
+    gb->apu.set_output(false);
+
+    gb->emulate();
+
+    gb->apu.set_output(audio);
+    gb->joypad.poll = std::move(poll);
+    push();
+    return true;
+}
@@ -0,0 +1,70 @@
+#ifndef REWIND_HPP
+#define REWIND_HPP
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "../state/state.hpp"
+class GameBoy;
+
+// Rewind buffer
+// Keeps an undo log of past frames in a fixed-size ring buffer. Each
+// frame only the 256-byte pages of memory and VRAM that were written
+// since the previous frame are stored, along with the small CPU/PPU
+// register state. When the buffer is full, the oldest frames are dropped.
+//
+// Call push() once after every emulated frame and rewind() to step back
+// one frame, or step_back() to also redraw the framebuffer. After loading
+// a state by other means, call reset().
+
+class Rewind {
+    private:
+        GameBoy* gb;
+
+        // Store pages XORed against the following frame and run-length
+        // encode the runs of zeros
+        bool compress;
+
+        // Ring buffer of frame records
+        std::vector<uint8_t> buffer;
+        size_t head;
+
+        struct Record {
+            size_t offset;
+            size_t size;
+        };
+        std::deque<Record> records;
+
+        // State of the machine as of the last push()
+        State shadow;
+
+        // Record being built by push()
+        std::vector<uint8_t> scratch;
+
+        void store_page(size_t&, uint8_t, uint8_t, uint8_t*, const uint8_t*);
+        void clear_dirty();
+
+    public:
+        // budget is the size of the ring buffer in bytes
+        Rewind(GameBoy*, size_t budget, bool compress = false);
+
+        // Record the frame that was just emulated
+        void push();
+
+        // Step back one frame. Returns false if there is no history left.
+        bool rewind();
+
+        // Step back one frame and leave the framebuffer showing it, by
+        // going back two and emulating one again. Returns false if there
+        // is no history left.
+        bool step_back();
+
+        // Drop all history and start over from the current state
+        void reset();
+
+        // Number of frames that can be rewound
+        size_t frames() const { return records.size(); }
+};
+
+#endif // REWIND_HPP
@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <memory>
+#include "rugbe.h"
+#include "gameboy.hpp"
+#include "metrics/metrics.hpp"
+#include "rewind/rewind.hpp"
+#include "screen/screen.hpp"
+#include "screen/screenshot.hpp"
+
+struct rugbe {
+    GameBoy gb;
+    Metrics metrics;
+    InputQueue inputs;
+
+    // Set by rugbe_rewind_enable
+    std::unique_ptr<Rewind> rewind;
+
+    // Started by the first screenshot
+    std::unique_ptr<ScreenshotWriter> screenshots;
+};
+
+// No exception may cross into C: the entry points that can throw (on
+// allocation or starting a thread) catch it and report failure instead
+
+rugbe_t* rugbe_create(void) {
+    rugbe_t* handle;
+    try {
+        handle = new rugbe;
+    } catch (...) {
+        return nullptr;
+    }
+    handle->gb.test_boot_rom();
+    handle->gb.joypad.queue = &handle->inputs;
+    return handle;
+}
+
+void rugbe_destroy(rugbe_t* handle) { delete handle; }
+
+int rugbe_load_rom_file(rugbe_t* handle, const char* path) {
+    try {
+        return handle->gb.load_rom(path) ? 0 : -1;
+    } catch (...) {
+        return -1;
+    }
+}
+
+int rugbe_load_rom(rugbe_t* handle, const uint8_t* data, size_t size) {
+    try {
+        return handle->gb.load_rom(data, size) ? 0 : -1;
+    } catch (...) {
+        return -1;
+    }
+}
+
+// Everything kept per frame, after each frame emulated
+static void end_frame(rugbe_t* handle) {
+    handle->metrics.frame(handle->gb);
+    if (handle->rewind) handle->rewind->push();
+}
+
+void rugbe_run_frames(rugbe_t* handle, int frames) {
+    for (int i = 0; i < frames; ++i) {
+        handle->gb.emulate();
+        end_frame(handle);
+    }
+}
+
+void rugbe_run_cycles(rugbe_t* handle, int cycles) {
+    GameBoy& gb = handle->gb;
+
+    while (cycles > 0) {
+        if (gb.cpu.cycles >= FRAME_CYCLES) gb.begin_frame();
+
+        int start = gb.cpu.cycles;
+        gb.run_until(std::min(FRAME_CYCLES, start + cycles));
+        cycles -= gb.cpu.cycles - start;
+    }
+}
+
+void rugbe_set_input(rugbe_t* handle, uint8_t buttons) {
+    handle->gb.joypad.set(buttons);
+}
+
+int rugbe_queue_input(rugbe_t* handle, uint64_t cycle, uint8_t buttons) {
+    return handle->inputs.push({cycle, buttons}) ? 0 : -1;
+}
+
+uint64_t rugbe_get_cycle(rugbe_t* handle) {
+    return handle->gb.cpu.clock();
+}
+
+const uint32_t* rugbe_get_frame(rugbe_t* handle) {
+    return reinterpret_cast<const uint32_t*>(handle->gb.ppu.framebuffer.data());
+}
+
+void rugbe_frame_hash(rugbe_t* handle, uint8_t hash[16]) {
+    hash_frame(handle->gb.ppu.framebuffer).to_bytes(hash);
+}
+
+int rugbe_run_until_hash(rugbe_t* handle, const uint8_t hash[16],
+                         int max_frames) {
+    return run_until_hash(handle->gb, Hash128::from_bytes(hash), max_frames,
+                          [handle](GameBoy&) { end_frame(handle); });
+}
+
+int rugbe_save_screenshot(rugbe_t* handle, const char* path) {
+    try {
+        if (!handle->screenshots) {
+            handle->screenshots = std::make_unique<ScreenshotWriter>();
+        }
+        return handle->screenshots->save(handle->gb.ppu.framebuffer, path)
+               ? 0 : -1;
+    } catch (...) {
+        return -1;
+    }
+}
+
+uint64_t rugbe_screenshot_failures(rugbe_t* handle) {
+    return handle->screenshots ? handle->screenshots->failed() : 0;
+}
+
+size_t rugbe_state_size(void) { return sizeof(State); }
+
+int rugbe_save_state(rugbe_t* handle, void* buffer, size_t size) {
+    if (size < sizeof(State)) return -1;
+
+    handle->gb.save_state(*static_cast<State*>(buffer));
+    return 0;
+}
+
+int rugbe_load_state(rugbe_t* handle, const void* buffer, size_t size) {
+    if (size < sizeof(State)) return -1;
+
+    if (!handle->gb.load_state(*static_cast<const State*>(buffer))) return -1;
+    if (handle->rewind) handle->rewind->reset();
+    return 0;
+}
+
+int rugbe_rewind_enable(rugbe_t* handle, size_t budget) {
+    handle->rewind.reset();
+    if (budget == 0) return 0;
+
+    try {
+        handle->rewind = std::make_unique<Rewind>(&handle->gb, budget, true);
+    } catch (...) {
+        return -1;
+    }
+    return 0;
+}
+
+int rugbe_rewind_step(rugbe_t* handle) {
+    return handle->rewind && handle->rewind->step_back() ? 0 : -1;
+}
+
+size_t rugbe_rewind_frames(rugbe_t* handle) {
+    return handle->rewind ? handle->rewind->frames() : 0;
+}
+
+void rugbe_get_metrics(rugbe_t* handle, rugbe_metrics_t* metrics) {
+    MetricsSnapshot snapshot = handle->metrics.snapshot();
+    metrics->instructions_per_sec = snapshot.instructions_per_sec;
+    metrics->frames_per_sec = snapshot.frames_per_sec;
+    metrics->speed = snapshot.speed;
+    metrics->frame_ms_p50 = snapshot.frame_ms_p50;
+    metrics->frame_ms_p95 = snapshot.frame_ms_p95;
+    metrics->frame_ms_p99 = snapshot.frame_ms_p99;
+    metrics->halted_percent = snapshot.halted_percent;
+    metrics->present_ms = snapshot.present_ms;
+}
+
+void rugbe_frame_presented(rugbe_t* handle) {
+    handle->metrics.presented();
+}
@@ -0,0 +1,134 @@
+#ifndef RUGBE_H
+#define RUGBE_H
+#include <stddef.h>
+#include <stdint.h>
+
+/*********************************************************************
+ * librugbe: embeddable emulator API
+ *
+ * Each handle is a fully independent machine with no shared or global
+ * state, so any number of instances can run in one process, each on its
+ * own thread. Nothing in this API exits the process or writes to the
+ * console; failures are reported through return values (0 on success,
+ * -1 on failure).
+ *********************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct rugbe rugbe_t;
+
+/* Frame dimensions; frames are ARGB8888 pixels */
+#define RUGBE_FRAME_WIDTH  160
+#define RUGBE_FRAME_HEIGHT 144
+
+/* Input bits for rugbe_set_input, set while a button is held */
+#define RUGBE_RIGHT  0x01
+#define RUGBE_LEFT   0x02
+#define RUGBE_UP     0x04
+#define RUGBE_DOWN   0x08
+#define RUGBE_A      0x10
+#define RUGBE_B      0x20
+#define RUGBE_SELECT 0x40
+#define RUGBE_START  0x80
+
+/* Create/destroy an instance. rugbe_create returns NULL on failure. */
+rugbe_t* rugbe_create(void);
+void rugbe_destroy(rugbe_t*);
+
+/* Load a ROM from a file or from memory */
+int rugbe_load_rom_file(rugbe_t*, const char* path);
+int rugbe_load_rom(rugbe_t*, const uint8_t* data, size_t size);
+
+/* Run whole frames, or a number of cycles (which may span frames) */
+void rugbe_run_frames(rugbe_t*, int frames);
+void rugbe_run_cycles(rugbe_t*, int cycles);
+
+/* Set the buttons currently held */
+void rugbe_set_input(rugbe_t*, uint8_t buttons);
+
+/* Hold buttons from an exact cycle on, as counted by rugbe_get_cycle.
+ * One other thread may queue inputs for an instance while it runs,
+ * without locking; queue them in cycle order. Returns -1 if the queue
+ * is full. */
+int rugbe_queue_input(rugbe_t*, uint64_t cycle, uint8_t buttons);
+
+/* Cycles emulated since the instance was created. Call it from the
+ * thread running the instance. */
+uint64_t rugbe_get_cycle(rugbe_t*);
+
+/* The last rendered frame. Valid until the next run call. */
+const uint32_t* rugbe_get_frame(rugbe_t*);
+
+/* 128-bit hash of the last rendered frame, as 16 bytes, most
+ * significant first */
+void rugbe_frame_hash(rugbe_t*, uint8_t hash[16]);
+
+/* Run frames until the frame hash equals hash, or max_frames have run.
+ * Returns the frames run when it matched, or -1. */
+int rugbe_run_until_hash(rugbe_t*, const uint8_t hash[16], int max_frames);
+
+/* Save the last rendered frame as a PNG. Encoding and writing happen on
+ * a background thread, which rugbe_destroy waits for. Returns -1 if too
+ * many screenshots are already waiting. */
+int rugbe_save_screenshot(rugbe_t*, const char* path);
+
+/* Screenshots accepted by rugbe_save_screenshot that then couldn't be
+ * written. They fail on the background thread, so a failure shows up
+ * here some time after the call. */
+uint64_t rugbe_screenshot_failures(rugbe_t*);
+
+/* Save/load a state to/from a caller-provided buffer of at least
+ * rugbe_state_size() bytes, aligned as malloc'd memory is. Neither
+ * allocates. A state doesn't include the ROM, so load it into a handle
+ * running the ROM it was saved from. */
+size_t rugbe_state_size(void);
+int rugbe_save_state(rugbe_t*, void* buffer, size_t size);
+int rugbe_load_state(rugbe_t*, const void* buffer, size_t size);
+
+/* Keep up to budget bytes of rewind history, recording each frame run
+ * with rugbe_run_frames or rugbe_run_until_hash. A budget of 0 turns
+ * rewind off. Loading a state drops the history. */
+int rugbe_rewind_enable(rugbe_t*, size_t budget);
+
+/* Step back one frame, leaving rugbe_get_frame showing it. Returns -1 if
+ * rewind is off or no history is left. */
+int rugbe_rewind_step(rugbe_t*);
+
+/* Frames that can be stepped back */
+size_t rugbe_rewind_frames(rugbe_t*);
+
+/* Rolling performance metrics over the last frames run with
+ * rugbe_run_frames or rugbe_run_until_hash */
+typedef struct {
+    double instructions_per_sec;
+    double frames_per_sec;
+
+    /* frames_per_sec relative to the real hardware; below 1 is slower
+     * than real time */
+    double speed;
+
+    /* Host time between frames */
+    double frame_ms_p50;
+    double frame_ms_p95;
+    double frame_ms_p99;
+
+    /* Emulated time the CPU spent halted */
+    double halted_percent;
+
+    /* Average time from the end of a frame to rugbe_frame_presented, or 0
+     * if it is never called */
+    double present_ms;
+} rugbe_metrics_t;
+
+void rugbe_get_metrics(rugbe_t*, rugbe_metrics_t*);
+
+/* Tell the instance the last frame is on screen, for present_ms */
+void rugbe_frame_presented(rugbe_t*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RUGBE_H */
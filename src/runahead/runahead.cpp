@@ -0,0 +1,74 @@
+#include <chrono>
+#include "runahead.hpp"
+#include "../profile/zones.hpp"
+
+RunAhead::RunAhead(GameBoy* gb, int frames, bool second_instance)
+    : gb {gb}, frames {frames}, total_ns {0}, total_frames {0}
+{
+    // A state doesn't hold the ROM, so the second machine gets its own copy
+    if (second_instance) {
+        ahead = std::make_unique<GameBoy>();
+        ahead->load_rom(&gb->mmu.at(0), 0x8000);
+    }
+}
+
+void RunAhead::emulate() {
+    // The real frame
+    gb->emulate();
+
+    if (frames <= 0) return;
+
+    ZONE("run-ahead");
+    auto start = std::chrono::steady_clock::now();
+
+    gb->save_state(state);
+    if (ahead) {
+        ahead->load_state(state);
+        for (int i = 0; i < frames; ++i) {
+            ahead->emulate();
+        }
+    } else {
+        // Frames that are rolled back mustn't be heard, traced, profiled
+        // or counted, and the counters aren't part of the state
+        bool audio = gb->apu.output_enabled();
+        gb->apu.set_output(false);
+        Tracer* tracer = gb->cpu.tracer;
+        gb->cpu.tracer = nullptr;
+        uint64_t instructions = gb->cpu.instructions;
+        uint64_t halted_cycles = gb->cpu.halted_cycles;
+#ifdef RUGBE_PROFILE
+        gb->cpu.profiler.enabled = false;
+#endif
+
+        for (int i = 0; i < frames; ++i) {
+            gb->emulate();
+        }
+
+        // The framebuffer isn't part of the state, so it keeps the
+        // run-ahead frame until the next real frame is rendered
+        gb->load_state(state);
+        gb->apu.set_output(audio);
+        gb->cpu.tracer = tracer;
+        gb->cpu.instructions = instructions;
+        gb->cpu.halted_cycles = halted_cycles;
+#ifdef RUGBE_PROFILE
+        gb->cpu.profiler.enabled = true;
+#endif
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    total_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    end - start).count();
+    total_frames += frames;
+}
+
+const std::array<Pixel, 160 * 144>& RunAhead::framebuffer() const {
+    return ahead ? ahead->ppu.framebuffer : gb->ppu.framebuffer;
+}
+
+double RunAhead::overhead() {
+    double us = total_frames ? total_ns / 1000.0 / total_frames : 0.0;
+    total_ns = 0;
+    total_frames = 0;
+    return us;
+}
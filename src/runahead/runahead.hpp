@@ -0,0 +1,44 @@
+#ifndef RUNAHEAD_HPP
+#define RUNAHEAD_HPP
+#include <array>
+#include <cstdint>
+#include <memory>
+
+#include "../gameboy.hpp"
+
+// Run-ahead
+// Hides the input lag built into a game. Each host frame, the machine
+// emulates one real frame, then a copy of it runs a further N frames
+// with the same input and the last of those is presented.
+//
+// By default the copy is made by saving the state, running ahead and
+// restoring it. With second_instance set, the state is instead loaded
+// into a separate machine that does the running ahead, so the primary
+// machine is never restored.
+
+class RunAhead {
+    private:
+        GameBoy* gb;
+        std::unique_ptr<GameBoy> ahead;
+        int frames;
+        State state;
+
+        // Time spent running ahead, for overhead reporting
+        uint64_t total_ns;
+        uint64_t total_frames;
+
+    public:
+        RunAhead(GameBoy*, int frames, bool second_instance = false);
+
+        // Emulate one host frame
+        void emulate();
+
+        // The frame to present for the last host frame
+        const std::array<Pixel, 160 * 144>& framebuffer() const;
+
+        // Average host time per run-ahead frame in microseconds,
+        // including its share of the save/restore. Resets the average.
+        double overhead();
+};
+
+#endif // RUNAHEAD_HPP
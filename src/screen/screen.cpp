@@ -0,0 +1,16 @@
+#include "screen.hpp"
+#include "../gameboy.hpp"
+
+Hash128 hash_frame(const std::array<Pixel, 160 * 144>& framebuffer) {
+    return hash128(framebuffer.data(), sizeof(framebuffer));
+}
+
+int run_until_hash(GameBoy& gb, const Hash128& target, int max_frames,
+                   const std::function<void(GameBoy&)>& on_frame) {
+    for (int frame = 1; frame <= max_frames; ++frame) {
+        gb.emulate();
+        if (on_frame) on_frame(gb);
+        if (hash_frame(gb.ppu.framebuffer) == target) return frame;
+    }
+    return -1;
+}
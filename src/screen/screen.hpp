@@ -0,0 +1,23 @@
+#ifndef SCREEN_HPP
+#define SCREEN_HPP
+#include <array>
+#include <functional>
+
+#include "../ppu/ppu.hpp"
+#include "../util/hash.hpp"
+class GameBoy;
+
+// Screen checks
+// Test ROMs and regression runs compare final screens by hash, which
+// turns a screen comparison into a 16-byte comparison.
+
+// Hash of a frame's pixels
+Hash128 hash_frame(const std::array<Pixel, 160 * 144>&);
+
+// Emulate frames until the framebuffer hashes to target or max_frames
+// have run. Returns the frames emulated when it matched, or -1. on_frame,
+// if given, is called after every frame.
+int run_until_hash(GameBoy&, const Hash128& target, int max_frames,
+                   const std::function<void(GameBoy&)>& on_frame = nullptr);
+
+#endif // SCREEN_HPP
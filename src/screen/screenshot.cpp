@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <fstream>
+#include "screenshot.hpp"
+#include "../profile/zones.hpp"
+
+// CRC-32 as used by PNG chunks
+struct CrcTable {
+    uint32_t entries[256];
+
+    CrcTable() {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+            }
+            entries[n] = c;
+        }
+    }
+};
+
+static const CrcTable CRC_TABLE;
+
+static uint32_t crc32(const uint8_t* data, size_t size) {
+    uint32_t c = 0xffffffff;
+    for (size_t i = 0; i < size; ++i) {
+        c = CRC_TABLE.entries[(c ^ data[i]) & 0xff] ^ (c >> 8);
+    }
+    return c ^ 0xffffffff;
+}
+
+static void put32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(value >> 24);
+    out.push_back(value >> 16);
+    out.push_back(value >> 8);
+    out.push_back(value);
+}
+
+// Append a chunk: length, type, data, then the CRC of type and data
+static void put_chunk(std::vector<uint8_t>& out, const char* type,
+                      const std::vector<uint8_t>& data) {
+    put32(out, data.size());
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    put32(out, crc32(out.data() + start, out.size() - start));
+}
+
+std::vector<uint8_t> encode_png(const std::array<Pixel, 160 * 144>& frame) {
+    // Rows of RGB, each after a filter type byte of 0 (none)
+    std::vector<uint8_t> raw;
+    raw.reserve(144 * (1 + 160 * 3));
+    for (int y = 0; y < 144; ++y) {
+        raw.push_back(0);
+        for (int x = 0; x < 160; ++x) {
+            uint32_t p = frame[y * 160 + x];
+            raw.push_back(p >> 16);
+            raw.push_back(p >> 8);
+            raw.push_back(p);
+        }
+    }
+
+    // zlib stream of stored deflate blocks, up to 65535 bytes each, then
+    // the Adler-32 of the data
+    std::vector<uint8_t> zlib {0x78, 0x01};
+    for (size_t pos = 0; pos < raw.size(); pos += 65535) {
+        size_t length = std::min<size_t>(65535, raw.size() - pos);
+        zlib.push_back(pos + length == raw.size() ? 1 : 0);
+        zlib.push_back(length);
+        zlib.push_back(length >> 8);
+        zlib.push_back(~length);
+        zlib.push_back(~length >> 8);
+        zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + length);
+    }
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    put32(zlib, (b << 16) | a);
+
+    // 160x144, 8 bits per channel, RGB
+    std::vector<uint8_t> header;
+    put32(header, 160);
+    put32(header, 144);
+    header.insert(header.end(), {8, 2, 0, 0, 0});
+
+    std::vector<uint8_t> png {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    put_chunk(png, "IHDR", header);
+    put_chunk(png, "IDAT", zlib);
+    put_chunk(png, "IEND", {});
+    return png;
+}
+
+ScreenshotWriter::ScreenshotWriter(size_t max_jobs)
+    : max_jobs {max_jobs}, quit {false}, failures {0}
+{
+    thread = std::thread(&ScreenshotWriter::run, this);
+}
+
+ScreenshotWriter::~ScreenshotWriter() {
+    finish();
+}
+
+void ScreenshotWriter::finish() {
+    if (!thread.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+bool ScreenshotWriter::save(const std::array<Pixel, 160 * 144>& frame,
+                            const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (jobs.size() >= max_jobs) return false;
+        jobs.push_back({frame, path});
+    }
+    wake.notify_one();
+    return true;
+}
+
+void ScreenshotWriter::run() {
+    name_zone_thread("screenshot");
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return !jobs.empty() || quit; });
+        if (jobs.empty()) return;
+
+        // Encode without holding the lock, so save() never waits on it
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+
+        {
+            ZONE("screenshot");
+            std::vector<uint8_t> png = encode_png(job.frame);
+            std::ofstream file(job.path, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(png.data()), png.size());
+            if (!file) failures.fetch_add(1);
+        }
+
+        lock.lock();
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef SCREENSHOT_HPP
+#define SCREENSHOT_HPP
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../ppu/ppu.hpp"
+
+// Encode a frame as an RGB PNG. The image data is stored rather than
+// compressed, which needs no zlib and is still only 69 KB.
+std::vector<uint8_t> encode_png(const std::array<Pixel, 160 * 144>&);
+
+// Screenshot writer
+// Encodes and writes screenshots on a thread of its own, so taking one
+// costs the caller only a copy of the framebuffer.
+
+class ScreenshotWriter {
+    private:
+        struct Job {
+            std::array<Pixel, 160 * 144> frame;
+            std::string path;
+        };
+
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<Job> jobs;
+        size_t max_jobs;
+        bool quit;
+
+        std::atomic<uint64_t> failures;
+
+        void run();
+
+    public:
+        ScreenshotWriter(size_t max_jobs = 16);
+
+        // Calls finish()
+        ~ScreenshotWriter();
+
+        ScreenshotWriter(const ScreenshotWriter&) = delete;
+        ScreenshotWriter& operator=(const ScreenshotWriter&) = delete;
+
+        // Queue a frame to be saved as a PNG at path. Returns false if
+        // max_jobs are already waiting.
+        bool save(const std::array<Pixel, 160 * 144>&, const std::string& path);
+
+        // Write the screenshots still queued and stop the writer. Nothing
+        // may be saved after this.
+        void finish();
+
+        // Screenshots that couldn't be written
+        uint64_t failed() const { return failures.load(); }
+};
+
+#endif // SCREENSHOT_HPP
@@ -0,0 +1,20 @@
+#ifndef SERIAL_HPP
+#define SERIAL_HPP
+#include <cstdint>
+#include <string>
+
+// Serial port ($ff01 SB, $ff02 SC)
+// The registers live in memory, where the MMU handles transfers. There
+// is never a link partner: a transfer on the internal clock shifts SB out
+// and $ff in. The bytes sent are kept here, which is how test ROMs
+// report their results.
+
+class Serial {
+    public:
+        // Bytes sent since the output was last cleared
+        std::string output;
+
+        void send(uint8_t byte) { output.push_back(byte); }
+};
+
+#endif // SERIAL_HPP
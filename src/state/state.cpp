@@ -0,0 +1,53 @@
+#include <atomic>
+#include <fstream>
+#include "state.hpp"
+
+bool write_state_file(const char* filepath, const State& state) {
+    std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+
+    file.write(reinterpret_cast<const char*>(&state), sizeof(State));
+    return static_cast<bool>(file);
+}
+
+bool read_state_file(const char* filepath, State& state) {
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file) return false;
+
+    file.read(reinterpret_cast<char*>(&state), sizeof(State));
+    return file && state.valid();
+}
+
+int MappedState::newest() {
+    bool first = slot(0).valid();
+    bool second = slot(1).valid();
+    if (first && second) {
+        // Sequence numbers may wrap around
+        int32_t ahead = slot(1).sequence - slot(0).sequence;
+        return ahead > 0 ? 1 : 0;
+    }
+    return first ? 0 : second ? 1 : -1;
+}
+
+const State* MappedState::latest() {
+    int n = newest();
+    return n < 0 ? nullptr : &slot(n);
+}
+
+State& MappedState::next() {
+    int n = newest();
+    State& state = slot(n == 0 ? 1 : 0);
+
+    // Until commit(), the slot counts as the older of the two, even once
+    // the save into it is complete
+    state.magic = 0;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    if (n >= 0) state.sequence = slot(n).sequence - 1;
+    return state;
+}
+
+void MappedState::commit(State& state) {
+    State& other = &state == &slot(0) ? slot(1) : slot(0);
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    state.sequence = other.valid() ? other.sequence + 1 : 0;
+}
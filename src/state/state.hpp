@@ -0,0 +1,162 @@
+#ifndef STATE_HPP
+#define STATE_HPP
+#include <array>
+#include <cstdint>
+
+#include "../util/mapped_file.hpp"
+
+// Save state format
+// A state is a single fixed-size block that is written and read with
+// plain copies, so saving and loading never allocate. The header
+// identifies the format; bump STATE_VERSION whenever the layout of any
+// of the structs below changes.
+
+const uint32_t STATE_MAGIC   = 0x53424752; // "RGBS"
+const uint16_t STATE_VERSION = 8;
+
+// First address of the memory kept in a state. Below it are the ROM,
+// which is loaded rather than saved, and VRAM, held by the PPU.
+const uint16_t STATE_MEMORY_BASE = 0xa000;
+
+struct CpuState {
+    uint16_t af;
+    uint16_t bc;
+    uint16_t de;
+    uint16_t hl;
+    uint16_t sp;
+    uint16_t pc;
+    int32_t  cycles;
+    uint8_t  ime;
+    uint8_t  halted;
+    uint8_t  ei_delay;
+    uint8_t  halt_bug;
+};
+
+struct PpuState {
+    int32_t mode_clock;
+    uint8_t mode;
+    uint8_t bg_switch;
+    uint8_t bg_map;
+    uint8_t bg_tile;
+    uint8_t lcd_switch;
+    uint8_t scy;
+    uint8_t scx;
+    uint8_t scanline;
+    uint8_t palette;
+};
+
+struct JoypadState {
+    uint8_t buttons;
+    uint8_t select;
+};
+
+struct TimerState {
+    uint16_t counter;
+    uint8_t  tima;
+    uint8_t  tma;
+    uint8_t  tac;
+    uint8_t  reserved;
+};
+
+struct ApuChannelState {
+    uint8_t  enabled;
+    uint8_t  volume;
+    uint8_t  envelope_timer;
+    uint8_t  position;
+    uint16_t length;
+    uint16_t reserved;
+    int32_t  timer;
+};
+
+struct ApuState {
+    uint8_t  registers[48];
+    ApuChannelState channels[4];
+    uint16_t sweep_shadow;
+    uint8_t  sweep_timer;
+    uint8_t  sweep_enabled;
+    uint16_t lfsr;
+    uint8_t  sequencer_step;
+    uint8_t  reserved;
+    uint32_t next_tick;
+};
+
+struct State {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t size;
+
+    // Orders the two slots of a mapped state
+    uint32_t sequence;
+
+    CpuState cpu;
+    PpuState ppu;
+    JoypadState joypad;
+    TimerState timer;
+    ApuState apu;
+
+    // Video RAM, held by the PPU
+    std::array<uint8_t, 8192> vram;
+
+    // Cartridge RAM, work RAM, OAM and I/O ($a000-$ffff)
+    std::array<uint8_t, 0x10000 - STATE_MEMORY_BASE> memory;
+
+    // Fill in the header for a state of the current version
+    void stamp() {
+        magic    = STATE_MAGIC;
+        version  = STATE_VERSION;
+        reserved = 0;
+        size     = sizeof(State);
+    }
+
+    // Check that the header matches the current version
+    bool valid() const {
+        return magic == STATE_MAGIC && version == STATE_VERSION &&
+               size == sizeof(State);
+    }
+};
+
+// Write/read a state to/from a file. Returns false on failure.
+bool write_state_file(const char*, const State&);
+bool read_state_file(const char*, State&);
+
+// A state file mapped directly into memory.
+// Saving into a mapped state only touches memory; the OS writes the
+// pages back to disk in the background, so a session can be checkpointed
+// every few frames and resumed instantly after a crash.
+//
+// The file holds two slots, and each save goes into the one not holding
+// the newest complete state. A save cut short by a crash then leaves the
+// previous checkpoint intact, and the half-written slot fails valid()
+// as GameBoy::save_state writes the header last.
+class MappedState {
+    private:
+        MappedFile file;
+
+        State& slot(int n) { return static_cast<State*>(file.data())[n]; }
+
+        // Slot of the newest complete state, or -1 if neither is complete
+        int newest();
+
+    public:
+        // Map the file at filepath, creating it if it does not exist
+        MappedState(const char* filepath)
+            : file {filepath, 2 * sizeof(State)} {}
+
+        // False if the file could not be mapped
+        bool valid() { return file.data() != nullptr; }
+
+        // The newest complete state, or nullptr if there is none
+        const State* latest();
+
+        // The slot to save the next checkpoint into
+        State& next();
+
+        // Mark a state saved into next() as the newest
+        void commit(State&);
+
+        // Ask the OS to write the mapped pages to disk now
+        void flush() { file.flush(); }
+};
+
+#endif // STATE_HPP
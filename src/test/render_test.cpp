@@ -0,0 +1,85 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "../gameboy.hpp"
+#include "../ppu/render_worker.hpp"
+#include "../state/state.hpp"
+
+// Render worker test
+// Runs a ROM that changes the scroll, palette and tile data on every
+// line on two machines, one drawing inline and one with a render worker,
+// saves and loads a state part way through a frame on both, and checks
+// that the worker presents the same frame the inline renderer drew.
+//
+// Usage: rugbe-test
+
+// Rewrites SCX, SCY and BGP from LY and fills tile data, forever
+static std::vector<uint8_t> raster_rom() {
+    std::vector<uint8_t> rom = {
+        0x3e, 0x91,             // LD A,$91
+        0xe0, 0x40,             // LDH ($40),A
+        0x21, 0x00, 0x80,       // LD HL,$8000
+        0xf0, 0x44,             // loop: LDH A,($44)
+        0xe0, 0x43,             // LDH ($43),A
+        0xe0, 0x42,             // LDH ($42),A
+        0xe0, 0x47,             // LDH ($47),A
+        0x22,                   // LD (HL+),A
+        0x7c,                   // LD A,H
+        0xfe, 0x98,             // CP $98
+        0x20, 0xf2,             // JR NZ,loop
+        0x26, 0x80,             // LD H,$80
+        0x18, 0xee              // JR loop
+    };
+    rom.resize(0x8000, 0x00);
+    return rom;
+}
+
+// Save part way into a frame, optionally run on, load the state back and
+// finish the frame. Returns true if both machines show the same frame.
+static bool check(int split, int frames_between) {
+    std::vector<uint8_t> rom = raster_rom();
+    auto inline_gb = std::make_unique<GameBoy>();
+    auto worker_gb = std::make_unique<GameBoy>();
+    RenderWorker worker;
+    worker_gb->ppu.worker = &worker;
+
+    auto inline_state = std::make_unique<State>();
+    auto worker_state = std::make_unique<State>();
+
+    for (GameBoy* gb : {inline_gb.get(), worker_gb.get()}) {
+        gb->load_rom(rom.data(), rom.size());
+        for (int i = 0; i < 3; ++i) gb->emulate();
+
+        gb->begin_frame();
+        gb->run_until(split);
+        gb->save_state(gb == inline_gb.get() ? *inline_state : *worker_state);
+
+        // As run-ahead does
+        gb->run_until(FRAME_CYCLES);
+        for (int i = 0; i < frames_between; ++i) gb->emulate();
+
+        gb->load_state(gb == inline_gb.get() ? *inline_state : *worker_state);
+        gb->run_until(FRAME_CYCLES);
+    }
+
+    // The worker's frame is presented at the next VBlank
+    worker_gb->emulate();
+
+    return worker_gb->ppu.framebuffer == inline_gb->ppu.framebuffer;
+}
+
+int main() {
+    int failed = 0;
+    for (int split : {456 * 20, 456 * 72 + 300, 456 * 143 + 400}) {
+        for (int frames_between : {0, 2}) {
+            bool same = check(split, frames_between);
+            std::cout << (same ? "PASS" : "FAIL")
+                      << "  worker frame after loading at cycle " << split
+                      << ", " << frames_between << " frames between"
+                      << std::endl;
+            if (!same) ++failed;
+        }
+    }
+    return failed ? 1 : 0;
+}
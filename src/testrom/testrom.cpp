@@ -0,0 +1,87 @@
+#include <chrono>
+#include "testrom.hpp"
+#include "../gameboy.hpp"
+#include "../screen/screen.hpp"
+
+const char* test_status_name(TestStatus status) {
+    switch (status) {
+        case TestStatus::PASSED: return "PASS";
+        case TestStatus::FAILED: return "FAIL";
+        case TestStatus::HUNG: return "HUNG";
+        case TestStatus::TIMED_OUT: return "TIME";
+    }
+    return "";
+}
+
+// Whether the instruction at pc jumps to itself with no interrupt able
+// to break the loop. ROMs waiting for a timer or VBlank interrupt spin
+// the same way with interrupts enabled.
+static bool spinning(GameBoy& gb) {
+    CpuState state;
+    gb.cpu.save_state(state);
+    uint16_t pc = state.pc;
+
+    bool interruptible = (state.ime || state.ei_delay) &&
+                         (gb.mmu.at(0xffff) & 0x1f);
+    if (interruptible) return false;
+
+    uint8_t op = gb.mmu.at(pc);
+    uint8_t lo = gb.mmu.at((pc + 1) & 0xffff);
+    uint8_t hi = gb.mmu.at((pc + 2) & 0xffff);
+    return (op == 0x18 && lo == 0xfe) ||
+           (op == 0xc3 && (lo | (hi << 8)) == pc);
+}
+
+TestResult run_test_rom(GameBoy& gb, uint64_t max_cycles) {
+    TestResult result {TestStatus::TIMED_OUT, "", 0, 0.0, {0, 0}};
+    auto start = std::chrono::steady_clock::now();
+
+    gb.serial.output.clear();
+
+    // Check once a frame; the ROMs spin for good once they are done
+    while (result.cycles < max_cycles) {
+        gb.emulate();
+        result.cycles += FRAME_CYCLES;
+
+        const std::string& output = gb.serial.output;
+        if (output.find("Passed") != std::string::npos) {
+            result.status = TestStatus::PASSED;
+            break;
+        }
+        if (output.find("Failed") != std::string::npos) {
+            result.status = TestStatus::FAILED;
+            break;
+        }
+        if (spinning(gb)) {
+            result.status = TestStatus::HUNG;
+            break;
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    result.output = gb.serial.output;
+    result.screen = hash_frame(gb.ppu.framebuffer);
+    return result;
+}
+
+TestResult run_screen_test(GameBoy& gb, const Hash128& screen,
+                           uint64_t max_cycles) {
+    TestResult result {TestStatus::TIMED_OUT, "", 0, 0.0, {0, 0}};
+    auto start = std::chrono::steady_clock::now();
+
+    gb.serial.output.clear();
+    int frames = run_until_hash(gb, screen, max_cycles / FRAME_CYCLES);
+    if (frames >= 0) {
+        result.status = TestStatus::PASSED;
+        result.cycles = uint64_t(frames) * FRAME_CYCLES;
+    } else {
+        result.cycles = max_cycles / FRAME_CYCLES * FRAME_CYCLES;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    result.output = gb.serial.output;
+    result.screen = hash_frame(gb.ppu.framebuffer);
+    return result;
+}
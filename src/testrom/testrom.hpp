@@ -0,0 +1,45 @@
+#ifndef TESTROM_HPP
+#define TESTROM_HPP
+#include <cstdint>
+#include <string>
+
+#include "../util/hash.hpp"
+class GameBoy;
+
+// Test ROM runner
+// Blargg-style test ROMs print their results to the serial port and then
+// spin forever. run_test_rom() runs one headlessly until its output says
+// "Passed" or "Failed", or the CPU is stuck jumping to itself (JR -2 or
+// JP to its own address), so a suite gates both correctness and speed in
+// one quick command.
+//
+// ROMs that only draw their result are checked by screen instead:
+// run_screen_test() passes once the frame hashes to the expected value.
+
+// Cycles per second of the real hardware
+const uint64_t CYCLES_PER_SECOND = 4194304;
+
+enum class TestStatus {PASSED, FAILED, HUNG, TIMED_OUT};
+
+struct TestResult {
+    TestStatus status;
+
+    // Everything the ROM sent over serial
+    std::string output;
+
+    uint64_t cycles;
+    double seconds;
+
+    // Hash of the final frame
+    Hash128 screen;
+};
+
+// Run the ROM already loaded into gb for at most max_cycles cycles
+TestResult run_test_rom(GameBoy&, uint64_t max_cycles);
+
+// Run it until its frame hashes to screen, for at most max_cycles cycles
+TestResult run_screen_test(GameBoy&, const Hash128& screen, uint64_t max_cycles);
+
+const char* test_status_name(TestStatus);
+
+#endif // TESTROM_HPP
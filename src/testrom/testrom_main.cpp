@@ -0,0 +1,112 @@
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "testrom.hpp"
+#include "../gameboy.hpp"
+#include "../screen/screenshot.hpp"
+
+// Run test ROMs headlessly and report results and speed
+// Usage: rugbe-testrom <rom>[=<screen hash>]... [--timeout <emulated seconds>]
+//                      [--verbose] [--hashes] [--screenshots <dir>]
+// A ROM given with a hash passes once its frame hashes to it. --hashes
+// prints each ROM's final frame hash, and --screenshots saves each final
+// frame as <dir>/<rom name>.png. Exits with 1 unless every ROM passes.
+
+int main(int argc, char** argv) {
+    std::vector<const char*> roms;
+    double timeout = 120;
+    bool verbose = false;
+    bool hashes = false;
+    const char* screenshot_dir = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) {
+            timeout = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+        } else if (std::strcmp(argv[i], "--hashes") == 0) {
+            hashes = true;
+        } else if (std::strcmp(argv[i], "--screenshots") == 0 && i + 1 < argc) {
+            screenshot_dir = argv[++i];
+        } else {
+            roms.push_back(argv[i]);
+        }
+    }
+
+    if (roms.empty()) {
+        std::cerr << "Usage: rugbe-testrom <rom>[=<screen hash>]... "
+                  << "[--timeout <emulated seconds>] [--verbose] [--hashes] "
+                  << "[--screenshots <dir>]" << std::endl;
+        return 1;
+    }
+
+    // Screenshots are encoded and written while the next ROMs run
+    std::unique_ptr<ScreenshotWriter> screenshots;
+    if (screenshot_dir) screenshots = std::make_unique<ScreenshotWriter>();
+
+    int passed = 0;
+    for (const char* arg : roms) {
+        // rom=hash checks the screen rather than the serial output
+        std::string rom = arg;
+        Hash128 screen;
+        size_t equals = rom.rfind('=');
+        bool by_screen = equals != std::string::npos;
+        if (by_screen) {
+            if (!Hash128::parse(rom.c_str() + equals + 1, screen)) {
+                std::cout << "FAIL  " << rom << ": bad screen hash" << std::endl;
+                continue;
+            }
+            rom.resize(equals);
+        }
+
+        auto gb = std::make_unique<GameBoy>();
+        if (!gb->load_rom(rom.c_str())) {
+            std::cout << "FAIL  " << rom << ": failed to open" << std::endl;
+            continue;
+        }
+        gb->skip_boot_rom();
+
+        uint64_t max_cycles = timeout * CYCLES_PER_SECOND;
+        TestResult result = by_screen
+                          ? run_screen_test(*gb, screen, max_cycles)
+                          : run_test_rom(*gb, max_cycles);
+        if (result.status == TestStatus::PASSED) ++passed;
+
+        double emulated = double(result.cycles) / CYCLES_PER_SECOND;
+        std::cout << test_status_name(result.status) << "  " << rom
+                  << std::fixed << std::setprecision(2)
+                  << "  " << emulated << " s in " << result.seconds << " s ("
+                  << result.cycles / result.seconds / 1e6 << " Mcycles/s, "
+                  << emulated / result.seconds << "x)" << std::endl;
+
+        if (hashes) {
+            std::cout << "      screen " << result.screen.hex() << std::endl;
+        }
+        if (screenshots) {
+            std::string name = rom.substr(rom.find_last_of("/\\") + 1);
+            std::string path = std::string(screenshot_dir) + "/" + name + ".png";
+            while (!screenshots->save(gb->ppu.framebuffer, path)) {
+                std::this_thread::yield();
+            }
+        }
+
+        if (verbose || result.status != TestStatus::PASSED) {
+            std::cout << result.output << std::endl;
+        }
+    }
+
+    if (screenshots) {
+        screenshots->finish();
+        if (screenshots->failed()) {
+            std::cerr << "Failed to write " << screenshots->failed()
+                      << " screenshots." << std::endl;
+        }
+    }
+
+    std::cout << passed << "/" << roms.size() << " passed" << std::endl;
+    return passed == static_cast<int>(roms.size()) ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+#include "timer.hpp"
+#include "../cpu/cpu.hpp"
+#include "../mmu/mmu.hpp"
+
+// Cycles between TIMA increments for each TAC clock select, as shifts.
+// TIMA increments on the falling edge of counter bit shift - 1.
+static const int TAC_SHIFTS[4] = {10, 4, 6, 8};
+
+Timer::Timer(Cpu* cpu, Mmu* mmu)
+    : cpu {cpu}, mmu {mmu}, div_base {0}, tima_sync {0},
+      tima {0}, tma {0}, tac {0}, event {UINT64_MAX} {}
+
+int Timer::shift() const {
+    return TAC_SHIFTS[tac & 0x03];
+}
+
+bool Timer::signal(uint64_t now) const {
+    return enabled() && (((now - div_base) >> (shift() - 1)) & 1);
+}
+
+void Timer::advance(uint64_t increments) {
+    while (increments >= uint64_t(0x100 - tima)) {
+        increments -= 0x100 - tima;
+        tima = tma;
+        mmu->request_interrupt(INT_TIMER);
+    }
+    tima += increments;
+}
+
+void Timer::sync() {
+    uint64_t now = cpu->clock();
+    if (enabled()) {
+        // Falling edges between the last sync and now
+        int s = shift();
+        advance(((now - div_base) >> s) - ((tima_sync - div_base) >> s));
+    }
+    tima_sync = now;
+}
+
+void Timer::schedule() {
+    if (!enabled()) {
+        event = UINT64_MAX;
+        return;
+    }
+
+    // The next falling edge, then one per increment left until overflow
+    int s = shift();
+    uint64_t next = div_base + ((((tima_sync - div_base) >> s) + 1) << s);
+    event = next + (uint64_t(0xff - tima) << s);
+}
+
+void Timer::overflow() {
+    sync();
+    schedule();
+}
+
+uint8_t Timer::read(uint16_t addr) {
+    switch (addr) {
+        case 0xff04:
+            return (cpu->clock() - div_base) >> 8;
+
+        case 0xff05:
+            sync();
+            return tima;
+
+        case 0xff06:
+            return tma;
+
+        default:
+            return tac | 0xf8;
+    }
+}
+
+void Timer::write(uint16_t addr, uint8_t data) {
+    sync();
+    uint64_t now = tima_sync;
+
+    switch (addr) {
+        // Resetting the counter is a falling edge if the selected bit
+        // was set
+        case 0xff04:
+            if (signal(now)) advance(1);
+            div_base = now;
+            break;
+
+        case 0xff05:
+            tima = data;
+            break;
+
+        case 0xff06:
+            tma = data;
+            break;
+
+        // Disabling the timer or selecting a bit that is clear is also a
+        // falling edge if the old bit was set
+        default: {
+            bool before = signal(now);
+            tac = data & 0x07;
+            if (before && !signal(now)) advance(1);
+            break;
+        }
+    }
+
+    schedule();
+}
+
+Timer::Registers Timer::registers() const {
+    // sync() and advance() on a copy of TIMA, without the interrupts
+    uint64_t now = cpu->clock();
+    uint8_t value = tima;
+    if (enabled()) {
+        int s = shift();
+        uint64_t increments = ((now - div_base) >> s) -
+                              ((tima_sync - div_base) >> s);
+        while (increments >= uint64_t(0x100 - value)) {
+            increments -= 0x100 - value;
+            value = tma;
+        }
+        value += increments;
+    }
+    return {static_cast<uint8_t>((now - div_base) >> 8), value, tac};
+}
+
+void Timer::save_state(TimerState& state) {
+    sync();
+    state.counter = tima_sync - div_base;
+    state.tima = tima;
+    state.tma = tma;
+    state.tac = tac;
+    state.reserved = 0;
+}
+
+void Timer::load_state(const TimerState& state) {
+    tima_sync = cpu->clock();
+    div_base = tima_sync - state.counter;
+    tima = state.tima;
+    tma = state.tma;
+    tac = state.tac;
+    schedule();
+}
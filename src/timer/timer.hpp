@@ -0,0 +1,76 @@
+#ifndef TIMER_HPP
+#define TIMER_HPP
+#include <cstdint>
+
+#include "../state/state.hpp"
+class Cpu;
+class Mmu;
+
+// Timer registers ($ff04-$ff07)
+// DIV is the top byte of a 16-bit counter running at the CPU clock, and
+// TIMA counts the falling edges of the counter bit selected by TAC.
+// Neither is counted as the CPU runs: both are derived from the CPU's
+// clock when read or written, and TIMA's next overflow is kept as a
+// single scheduled event, which GameBoy::step() fires once it is due.
+
+class Timer {
+    private:
+        Cpu* cpu;
+        Mmu* mmu;
+
+        // Clock at which the counter was last reset by a write to DIV
+        uint64_t div_base;
+
+        // Clock that TIMA has been brought up to
+        uint64_t tima_sync;
+
+        uint8_t tima;
+        uint8_t tma;
+        uint8_t tac;
+
+        bool enabled() const { return tac & 0x04; }
+
+        // Cycles between TIMA increments are 1 << shift()
+        int shift() const;
+
+        // Level of the counter bit selected by TAC, ANDed with the enable
+        bool signal(uint64_t) const;
+
+        // Count n increments into TIMA, reloading it from TMA and
+        // requesting the timer interrupt on each overflow
+        void advance(uint64_t);
+
+        // Bring TIMA up to the CPU's clock
+        void sync();
+
+        // Recompute event after TIMA or TAC change
+        void schedule();
+
+    public:
+        // Clock of TIMA's next overflow; UINT64_MAX while stopped
+        uint64_t event;
+
+        Timer(Cpu*, Mmu*);
+
+        uint8_t read(uint16_t);
+        void write(uint16_t, uint8_t);
+
+        // Handle the overflow due at event
+        void overflow();
+
+        // DIV, TIMA and TAC as they read at the CPU's clock, worked out
+        // without bringing TIMA up to it, for comparing machines
+        struct Registers {
+            uint8_t div;
+            uint8_t tima;
+            uint8_t tac;
+        };
+        Registers registers() const;
+
+        // Copy registers to/from a save state. Times are stored relative
+        // to the CPU's clock, which must be loaded first.
+        void save_state(TimerState&);
+        void load_state(const TimerState&);
+};
+
+#endif // TIMER_HPP
@@ -0,0 +1,142 @@
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include "trace.hpp"
+#include "../cpu/disassembler.hpp"
+
+// Smallest power of two >= n
+static size_t round_up(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+Tracer::Tracer(size_t capacity) : header {nullptr}, records {nullptr}, mask {0} {
+    capacity = round_up(capacity);
+    memory.resize(sizeof(TraceHeader) + capacity * sizeof(TraceRecord));
+    init(memory.data(), capacity);
+}
+
+Tracer::Tracer(const char* filepath, size_t capacity)
+    : header {nullptr}, records {nullptr}, mask {0}
+{
+    capacity = round_up(capacity);
+    file = std::make_unique<MappedFile>(
+        filepath, sizeof(TraceHeader) + capacity * sizeof(TraceRecord));
+    if (file->data() != nullptr) init(file->data(), capacity);
+}
+
+void Tracer::init(void* data, size_t capacity) {
+    header = new (data) TraceHeader;
+    header->magic = TRACE_MAGIC;
+    header->version = TRACE_VERSION;
+    header->record_size = sizeof(TraceRecord);
+    header->capacity = capacity;
+    header->head.store(0, std::memory_order_relaxed);
+
+    records = reinterpret_cast<TraceRecord*>(header + 1);
+    mask = capacity - 1;
+}
+
+void Tracer::snapshot(std::vector<TraceRecord>& out) const {
+    uint64_t capacity = mask + 1;
+    uint64_t head = header->head.load(std::memory_order_acquire);
+    uint64_t start = head > capacity ? head - capacity : 0;
+
+    out.clear();
+    for (uint64_t i = start; i < head; ++i) {
+        out.push_back(records[i & mask]);
+    }
+
+    // Drop anything the producer lapped while we were copying
+    uint64_t now = header->head.load(std::memory_order_acquire);
+    if (now > capacity && now - capacity > start) {
+        uint64_t lost = std::min<uint64_t>(now - capacity - start, out.size());
+        out.erase(out.begin(), out.begin() + lost);
+    }
+}
+
+bool Tracer::save(const char* filepath) const {
+    std::vector<TraceRecord> snap;
+    snapshot(snap);
+
+    std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+
+    // Saved traces hold exactly their records, oldest first
+    uint32_t magic = TRACE_MAGIC;
+    uint16_t version = TRACE_VERSION;
+    uint16_t record_size = sizeof(TraceRecord);
+    uint64_t count = snap.size();
+    file.write(reinterpret_cast<const char*>(&magic), 4);
+    file.write(reinterpret_cast<const char*>(&version), 2);
+    file.write(reinterpret_cast<const char*>(&record_size), 2);
+    file.write(reinterpret_cast<const char*>(&count), 8);
+    file.write(reinterpret_cast<const char*>(&count), 8);
+    file.write(reinterpret_cast<const char*>(snap.data()),
+               snap.size() * sizeof(TraceRecord));
+    return static_cast<bool>(file);
+}
+
+bool read_trace_file(const char* filepath, std::vector<TraceRecord>& out) {
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file) return false;
+
+    uint32_t magic;
+    uint16_t version, record_size;
+    uint64_t capacity, head;
+    file.read(reinterpret_cast<char*>(&magic), 4);
+    file.read(reinterpret_cast<char*>(&version), 2);
+    file.read(reinterpret_cast<char*>(&record_size), 2);
+    file.read(reinterpret_cast<char*>(&capacity), 8);
+    file.read(reinterpret_cast<char*>(&head), 8);
+    if (!file || magic != TRACE_MAGIC || version != TRACE_VERSION ||
+        record_size != sizeof(TraceRecord) || capacity == 0) {
+        return false;
+    }
+
+    // A Tracer's ring is a power of two; a saved trace holds exactly its
+    // records. Either way the records must all be in the file, which
+    // bounds the allocation on a corrupt capacity.
+    bool power_of_two = (capacity & (capacity - 1)) == 0;
+    if (!power_of_two && capacity != head) return false;
+
+    std::streamoff records_start = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::streamoff end = file.tellg();
+    file.seekg(records_start);
+    if (records_start < 0 || end < records_start ||
+        capacity > uint64_t(end - records_start) / sizeof(TraceRecord)) {
+        return false;
+    }
+
+    std::vector<TraceRecord> ring(capacity);
+    file.read(reinterpret_cast<char*>(ring.data()),
+              capacity * sizeof(TraceRecord));
+    if (!file) return false;
+
+    out.clear();
+    uint64_t start = head > capacity ? head - capacity : 0;
+    for (uint64_t i = start; i < head; ++i) {
+        out.push_back(ring[i % capacity]);
+    }
+    return true;
+}
+
+void print_record(std::ostream& out, const TraceRecord& record) {
+    char mnemonic[DISASSEMBLY_SIZE];
+    disassemble(mnemonic, record.bytes, record.pc);
+
+    out << std::hex << std::setfill('0')
+        << "$" << std::setw(4) << record.pc << "  "
+        << std::left << std::setfill(' ') << std::setw(20) << mnemonic
+        << std::right << std::setfill('0')
+        << "AF=" << std::setw(4) << record.af
+        << " BC=" << std::setw(4) << record.bc
+        << " DE=" << std::setw(4) << record.de
+        << " HL=" << std::setw(4) << record.hl
+        << " SP=" << std::setw(4) << record.sp
+        << std::dec << std::setfill(' ')
+        << "  cycle " << record.cycles << "\n";
+}
@@ -0,0 +1,100 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+#include "../util/mapped_file.hpp"
+
+// Execution trace
+// The CPU writes one fixed-size binary record per instruction into a
+// ring buffer, overwriting the oldest records when it is full. Records are
+// only formatted later, by rugbe-tracedump, so tracing costs a few stores
+// per instruction. The ring can live in memory or in a mapped file, which
+// keeps the last instructions before a crash.
+
+const uint32_t TRACE_MAGIC   = 0x54424752; // "RGBT"
+const uint16_t TRACE_VERSION = 1;
+
+// State before an instruction executes
+struct TraceRecord {
+    uint16_t pc;
+    uint16_t sp;
+    uint16_t af;
+    uint16_t bc;
+    uint16_t de;
+    uint16_t hl;
+
+    // Opcode and the two bytes after it
+    uint8_t  bytes[3];
+    uint8_t  reserved;
+
+    // Cycle counter within the frame
+    uint32_t cycles;
+};
+
+// Header of a trace file, followed by capacity records
+struct TraceHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint64_t capacity;
+
+    // Records written since the trace started; the newest record is at
+    // (head - 1) % capacity
+    std::atomic<uint64_t> head;
+};
+
+class Tracer {
+    private:
+        std::unique_ptr<MappedFile> file;
+        std::vector<uint8_t> memory;
+
+        TraceHeader* header;
+        TraceRecord* records;
+        uint64_t mask;
+
+        void init(void*, size_t);
+
+    public:
+        // A ring of capacity records (rounded up to a power of two) in
+        // memory, or in a mapped file at filepath
+        Tracer(size_t capacity);
+        Tracer(const char* filepath, size_t capacity);
+
+        Tracer(const Tracer&) = delete;
+        Tracer& operator=(const Tracer&) = delete;
+
+        // False if the file could not be mapped
+        bool valid() const { return header != nullptr; }
+
+        // Called by the producer (the CPU) only
+        TraceRecord& next() {
+            uint64_t head = header->head.load(std::memory_order_relaxed);
+            return records[head & mask];
+        }
+        void commit() {
+            uint64_t head = header->head.load(std::memory_order_relaxed);
+            header->head.store(head + 1, std::memory_order_release);
+        }
+
+        // Copy the records currently in the ring, oldest first. Safe to
+        // call from another thread while tracing; records overwritten
+        // during the copy are dropped.
+        void snapshot(std::vector<TraceRecord>&) const;
+
+        // Write the ring to a trace file
+        bool save(const char*) const;
+};
+
+// Read the records in a trace file, oldest first. Returns false if the
+// file is not a trace or its header doesn't match its contents.
+bool read_trace_file(const char*, std::vector<TraceRecord>&);
+
+// Print a record as one line: address, instruction and registers
+void print_record(std::ostream&, const TraceRecord&);
+
+#endif // TRACE_HPP
@@ -0,0 +1,35 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "trace.hpp"
+
+// Decode a trace file written by rugbe --trace
+// Usage: rugbe-tracedump <trace> [--last <count>]
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: rugbe-tracedump <trace> [--last <count>]"
+                  << std::endl;
+        return 1;
+    }
+
+    size_t last = 0;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--last") == 0 && i + 1 < argc) {
+            last = std::atol(argv[++i]);
+        }
+    }
+
+    std::vector<TraceRecord> records;
+    if (!read_trace_file(argv[1], records)) {
+        std::cerr << "Failed to read trace." << std::endl;
+        return 1;
+    }
+
+    size_t start = last && last < records.size() ? records.size() - last : 0;
+    for (size_t i = start; i < records.size(); ++i) {
+        print_record(std::cout, records[i]);
+    }
+
+    return 0;
+}
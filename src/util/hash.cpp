@@ -0,0 +1,183 @@
+#include <cstring>
+#include "hash.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static const uint64_t PRIME32_1 = 0x9e3779b1;
+static const uint64_t PRIME32_2 = 0x85ebca77;
+static const uint64_t PRIME32_3 = 0xc2b2ae3d;
+static const uint64_t PRIME64_1 = 0x9e3779b185ebca87;
+static const uint64_t PRIME64_2 = 0xc2b2ae3d27d4eb4f;
+static const uint64_t PRIME64_3 = 0x165667b19e3779f9;
+static const uint64_t PRIME64_4 = 0x85ebca77c2b2ae63;
+static const uint64_t PRIME64_5 = 0x27d4eb2f165667c5;
+
+// Lanes per stripe, and stripes between scrambles. Each stripe in a
+// block uses the secret one word further on.
+static const int LANES             = 8;
+static const int STRIPE_SIZE       = LANES * 8;
+static const int STRIPES_PER_BLOCK = 16;
+
+// Secret words: those used by the stripes, then the scramble's, then the
+// two halves' for the final merge
+static const int SCRAMBLE_SECRET = STRIPES_PER_BLOCK + LANES - 1;
+static const int LOW_SECRET      = SCRAMBLE_SECRET + LANES;
+static const int HIGH_SECRET     = LOW_SECRET + LANES;
+static const int SECRET_WORDS    = HIGH_SECRET + LANES;
+
+// Pseudo-random secret from a splitmix64 sequence
+struct Secret {
+    uint64_t words[SECRET_WORDS];
+
+    Secret() {
+        uint64_t x = PRIME64_5;
+        for (uint64_t& word : words) {
+            x += 0x9e3779b97f4a7c15;
+            uint64_t z = x;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            word = z ^ (z >> 31);
+        }
+    }
+};
+
+static const Secret SECRET;
+
+// Each lane adds the product of its keyed word's halves, and the word of
+// its neighbour. SSE2 does two lanes at once: a 32x32-bit multiply is a
+// single instruction there, and every x86-64 CPU has it.
+#ifdef __SSE2__
+static void accumulate(uint64_t* acc, const uint8_t* stripe,
+                       const uint64_t* secret) {
+    for (int i = 0; i < LANES; i += 2) {
+        __m128i value = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(stripe + i * 8));
+        __m128i keyed = _mm_xor_si128(value, _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(secret + i)));
+
+        // Multiply each low half by the high half, swapped down beside it
+        __m128i high = _mm_shuffle_epi32(keyed, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128i product = _mm_mul_epu32(keyed, high);
+        __m128i neighbour = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+
+        __m128i* lanes = reinterpret_cast<__m128i*>(acc + i);
+        _mm_storeu_si128(lanes, _mm_add_epi64(_mm_loadu_si128(lanes),
+                                              _mm_add_epi64(product, neighbour)));
+    }
+}
+#else
+static void accumulate(uint64_t* acc, const uint8_t* stripe,
+                       const uint64_t* secret) {
+    uint64_t values[LANES];
+    std::memcpy(values, stripe, STRIPE_SIZE);
+    for (int i = 0; i < LANES; ++i) {
+        uint64_t keyed = values[i] ^ secret[i];
+        acc[i] += (keyed & 0xffffffff) * (keyed >> 32) + values[i ^ 1];
+    }
+}
+#endif
+
+static void scramble(uint64_t* acc, const uint64_t* secret) {
+    for (int i = 0; i < LANES; ++i) {
+        acc[i] ^= acc[i] >> 47;
+        acc[i] ^= secret[i];
+        acc[i] *= PRIME32_1;
+    }
+}
+
+// Fold a 128-bit product down to 64 bits
+static uint64_t multiply_fold(uint64_t a, uint64_t b) {
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+}
+
+static uint64_t avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= 0x165667919e3779f9;
+    h ^= h >> 32;
+    return h;
+}
+
+Hash128 hash128(const void* data, size_t size) {
+    const uint8_t* in = static_cast<const uint8_t*>(data);
+    const uint64_t* secret = SECRET.words;
+
+    uint64_t acc[LANES] = {PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3,
+                           PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1};
+
+    size_t stripes = size / STRIPE_SIZE;
+    for (size_t s = 0; s < stripes; ++s) {
+        int n = s % STRIPES_PER_BLOCK;
+        accumulate(acc, in + s * STRIPE_SIZE, secret + n);
+        if (n == STRIPES_PER_BLOCK - 1) {
+            scramble(acc, secret + SCRAMBLE_SECRET);
+        }
+    }
+
+    // The rest, zero-padded to a stripe. The length goes into the merge,
+    // so padding can't collide with real zeros.
+    size_t rest = size % STRIPE_SIZE;
+    if (rest) {
+        uint8_t last[STRIPE_SIZE] = {};
+        std::memcpy(last, in + stripes * STRIPE_SIZE, rest);
+        accumulate(acc, last, secret + stripes % STRIPES_PER_BLOCK);
+    }
+
+    uint64_t low = size * PRIME64_1;
+    uint64_t high = ~(size * PRIME64_2);
+    for (int i = 0; i < LANES; i += 2) {
+        low += multiply_fold(acc[i] ^ secret[LOW_SECRET + i],
+                             acc[i + 1] ^ secret[LOW_SECRET + i + 1]);
+        high += multiply_fold(acc[i] ^ secret[HIGH_SECRET + i],
+                              acc[i + 1] ^ secret[HIGH_SECRET + i + 1]);
+    }
+    return {avalanche(low), avalanche(high)};
+}
+
+void Hash128::to_bytes(uint8_t* out) const {
+    for (int i = 0; i < 8; ++i) {
+        out[i] = high >> (56 - i * 8);
+        out[i + 8] = low >> (56 - i * 8);
+    }
+}
+
+Hash128 Hash128::from_bytes(const uint8_t* in) {
+    Hash128 hash {0, 0};
+    for (int i = 0; i < 8; ++i) {
+        hash.high = (hash.high << 8) | in[i];
+        hash.low = (hash.low << 8) | in[i + 8];
+    }
+    return hash;
+}
+
+std::string Hash128::hex() const {
+    static const char DIGITS[] = "0123456789abcdef";
+    uint8_t bytes[16];
+    to_bytes(bytes);
+
+    std::string text(32, '0');
+    for (int i = 0; i < 16; ++i) {
+        text[i * 2] = DIGITS[bytes[i] >> 4];
+        text[i * 2 + 1] = DIGITS[bytes[i] & 0x0f];
+    }
+    return text;
+}
+
+bool Hash128::parse(const char* text, Hash128& hash) {
+    if (std::strlen(text) != 32) return false;
+
+    uint8_t bytes[16];
+    for (int i = 0; i < 32; ++i) {
+        char c = text[i];
+        int digit = c >= '0' && c <= '9' ? c - '0'
+                  : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                  : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+        if (digit < 0) return false;
+        if (i % 2 == 0) bytes[i / 2] = digit << 4;
+        else bytes[i / 2] |= digit;
+    }
+    hash = from_bytes(bytes);
+    return true;
+}
@@ -0,0 +1,64 @@
+#include <cstdint>
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const char* filepath, size_t size)
+    : memory {nullptr}, size {size}, file {INVALID_HANDLE_VALUE},
+      mapping {nullptr}
+{
+    file = CreateFileA(filepath, GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                       OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return;
+
+    // Mapping a file larger than itself grows it to the mapping size
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE,
+                                 static_cast<DWORD>(uint64_t(size) >> 32),
+                                 static_cast<DWORD>(size), nullptr);
+    if (mapping == nullptr) return;
+
+    memory = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+}
+
+MappedFile::~MappedFile() {
+    if (memory != nullptr) UnmapViewOfFile(memory);
+    if (mapping != nullptr) CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+}
+
+void MappedFile::flush() {
+    if (memory != nullptr) FlushViewOfFile(memory, size);
+}
+
+#else
+
+MappedFile::MappedFile(const char* filepath, size_t size)
+    : memory {nullptr}, size {size}, fd {-1}
+{
+    fd = open(filepath, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return;
+
+    if (ftruncate(fd, size) < 0) return;
+
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p != MAP_FAILED) memory = p;
+}
+
+MappedFile::~MappedFile() {
+    if (memory != nullptr) munmap(memory, size);
+    if (fd >= 0) close(fd);
+}
+
+void MappedFile::flush() {
+    if (memory != nullptr) msync(memory, size, MS_ASYNC);
+}
+
+#endif
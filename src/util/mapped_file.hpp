@@ -0,0 +1,35 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+#include <cstddef>
+
+// A file of a fixed size mapped read/write into memory.
+// Writes to the mapping only touch memory; the OS writes the pages back
+// to the file in the background, and they survive a crash of the process.
+
+class MappedFile {
+    private:
+        void* memory;
+        size_t size;
+#ifdef _WIN32
+        void* file;
+        void* mapping;
+#else
+        int fd;
+#endif
+
+    public:
+        // Map the file at filepath, creating it and resizing it to size
+        MappedFile(const char*, size_t);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // nullptr if the file could not be mapped
+        void* data() { return memory; }
+
+        // Ask the OS to write the mapped pages to disk now
+        void flush();
+};
+
+#endif // MAPPED_FILE_HPP
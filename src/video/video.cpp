@@ -1,17 +1,57 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <vector>
 #include <SDL2/SDL.h>
 #include "video.hpp"
+#include "../profile/zones.hpp"
 
-SDL_Window* window = nullptr;
-SDL_Texture* texture = nullptr;
-SDL_Renderer* renderer = nullptr;
+// 3x5 font for the overlay. Each glyph is 5 rows of 3 bits, top row in the
+// high bits; characters without a glyph are drawn as spaces.
+struct Glyph {
+    char c;
+    uint16_t rows;
+};
 
-void setup_video() {
+static const Glyph FONT[] = {
+    {'0', 075557}, {'1', 026227}, {'2', 071747}, {'3', 071717},
+    {'4', 055711}, {'5', 074717}, {'6', 074757}, {'7', 071111},
+    {'8', 075757}, {'9', 075717}, {'.', 000002}, {'%', 051245},
+    {'A', 025755}, {'F', 074644}, {'H', 055755}, {'I', 072227},
+    {'L', 044447}, {'M', 057755}, {'P', 065644}, {'S', 034216},
+    {'T', 072222}, {'X', 055255}
+};
+
+// Screen pixels per font pixel
+const int OVERLAY_SCALE = 3;
+
+// Vsynced presents timed to measure the refresh rate
+const int MEASURE_FRAMES = 30;
+
+static uint16_t glyph(char c) {
+    for (const Glyph& g : FONT) {
+        if (g.c == c) return g.rows;
+    }
+    return 0;
+}
+
+Video::Video()
+    : window {nullptr}, renderer {nullptr}, texture {nullptr},
+      measured_rate {0.0} {}
+
+Video::~Video() {
+    if (texture != nullptr) SDL_DestroyTexture(texture);
+    if (renderer != nullptr) SDL_DestroyRenderer(renderer);
+    if (window != nullptr) SDL_DestroyWindow(window);
+}
+
+bool Video::setup(bool vsync) {
     // Initialize SDL
     if (SDL_Init(SDL_INIT_EVERYTHING) < 0) {
         std::cerr << "SDL initialization failure. SDL_Error: "
                   << SDL_GetError() << std::endl;
-        exit(1);
+        return false;
     }
 
     //Create window
@@ -21,17 +61,18 @@ void setup_video() {
     if (window == nullptr) {
         std::cerr << "Failed to create window. SDL_Error: " 
                   << SDL_GetError() << std::endl;
-        exit(1);
+        return false;
     }
 
     // Create renderer
-    renderer = SDL_CreateRenderer(window, -1, 0);
-    SDL_RenderSetLogicalSize(renderer, SCREEN_WIDTH, SCREEN_HEIGHT);
+    renderer = SDL_CreateRenderer(window, -1,
+                                  vsync ? SDL_RENDERER_PRESENTVSYNC : 0);
     if (renderer == nullptr) {
         std::cerr << "Failed to create renderer. SDL_Error: " 
                   << SDL_GetError() << std::endl;
-        exit(1);
+        return false;
     }
+    SDL_RenderSetLogicalSize(renderer, SCREEN_WIDTH, SCREEN_HEIGHT);
 
     // Create texture that stores frame buffer
     texture = SDL_CreateTexture(renderer,
@@ -41,16 +82,96 @@ void setup_video() {
     if (texture == nullptr) {
         std::cerr << "Failed to create texture. SDL_Error: " 
                   << SDL_GetError() << std::endl;
-        exit(1);
+        return false;
+    }
+
+    if (vsync) measure_refresh_rate();
+    return true;
+}
+
+void Video::measure_refresh_rate() {
+    std::vector<double> intervals;
+    auto last = std::chrono::steady_clock::now();
+    for (int i = 0; i < MEASURE_FRAMES; ++i) {
+        SDL_RenderClear(renderer);
+        SDL_RenderPresent(renderer);
+
+        auto now = std::chrono::steady_clock::now();
+        intervals.push_back(std::chrono::duration<double>(now - last).count());
+        last = now;
+    }
+
+    // The median shrugs off the first present and any hitches
+    std::sort(intervals.begin(), intervals.end());
+    double interval = intervals[intervals.size() / 2];
+    if (interval > 0) measured_rate = 1.0 / interval;
+}
+
+double Video::refresh_rate() const {
+    SDL_DisplayMode mode;
+    int nominal = SDL_GetWindowDisplayMode(window, &mode) < 0
+                ? 0 : mode.refresh_rate;
+
+    // SDL reports whole Hz, so a 59.94 Hz display shows up as 59 or 60.
+    // A measured rate within a hertz of that is the more exact one; one
+    // further off means presents weren't actually synced.
+    if (measured_rate > 0 &&
+        (nominal == 0 || std::abs(measured_rate - nominal) < 1.0)) {
+        return measured_rate;
     }
+    return nominal;
 }
 
-void draw(std::array<Pixel, 160 * 144> framebuffer) {
+void Video::draw(const std::array<Pixel, 160 * 144>& framebuffer,
+                 const char* overlay) {
+    ZONE("present");
+
     // Update texture
     SDL_UpdateTexture(texture, NULL, framebuffer.data(), 160 * sizeof(Uint32));
 
     // Clear screen and render
     SDL_RenderClear(renderer);  
     SDL_RenderCopy(renderer, texture, NULL, NULL);
+    if (overlay != nullptr) draw_overlay(overlay);
     SDL_RenderPresent(renderer);
-}
\ No newline at end of file
+}
+
+void Video::draw_overlay(const char* text) {
+    const int advance = 4 * OVERLAY_SCALE;
+    const int line_height = 6 * OVERLAY_SCALE;
+
+    std::vector<SDL_Rect> pixels;
+    int columns = 0, lines = 1, column = 0;
+    for (const char* c = text; *c; ++c) {
+        if (*c == '\n') {
+            column = 0;
+            ++lines;
+            continue;
+        }
+
+        uint16_t rows = glyph(*c);
+        for (int y = 0; y < 5; ++y) {
+            for (int x = 0; x < 3; ++x) {
+                if (rows & (1 << ((4 - y) * 3 + (2 - x)))) {
+                    pixels.push_back({
+                        OVERLAY_SCALE * 2 + column * advance + x * OVERLAY_SCALE,
+                        OVERLAY_SCALE * 2 + (lines - 1) * line_height +
+                            y * OVERLAY_SCALE,
+                        OVERLAY_SCALE, OVERLAY_SCALE});
+                }
+            }
+        }
+        columns = std::max(columns, ++column);
+    }
+
+    // Translucent backing so the text reads over any frame
+    SDL_Rect backing {0, 0, columns * advance + OVERLAY_SCALE * 3,
+                      lines * line_height + OVERLAY_SCALE * 3};
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
+    SDL_RenderFillRect(renderer, &backing);
+
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderFillRects(renderer, pixels.data(), pixels.size());
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+}
@@ -6,7 +6,37 @@
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 576;
 
-void setup_video();
-void draw(std::array<Pixel, 160 * 144>);
+// SDL window the frontend presents frames to
+class Video {
+    private:
+        SDL_Window* window;
+        SDL_Renderer* renderer;
+        SDL_Texture* texture;
 
-#endif // VIDEO_HPP
\ No newline at end of file
+        // Refresh rate timed over vsynced presents, or 0 if not measured
+        double measured_rate;
+
+        void draw_overlay(const char*);
+        void measure_refresh_rate();
+
+    public:
+        Video();
+        ~Video();
+
+        Video(const Video&) = delete;
+        Video& operator=(const Video&) = delete;
+
+        // Create the window. With vsync, presenting waits for the
+        // display's next refresh. Returns false on failure.
+        bool setup(bool vsync = false);
+
+        // Refresh rate of the window's display in Hz, or 0 if unknown
+        double refresh_rate() const;
+
+        // Present a frame, with lines of overlay text in the top left
+        // corner if overlay isn't null
+        void draw(const std::array<Pixel, 160 * 144>&,
+                  const char* overlay = nullptr);
+};
+
+#endif // VIDEO_HPP